@@ -0,0 +1,72 @@
+// DBC startup parse/compile time and per-frame decode cost.
+// Usage: bench_dbc [file.dbc] [frames]
+#include <stdio.h>
+#include <stdlib.h>
+#include "can/dbc_loader.h"
+#include "util/mono_time.h"
+
+#define LOAD_RUNS 200
+#define POOL_SIZE 4096  // Power of two
+
+typedef struct {
+    uint32_t id;
+    uint8_t dlc;
+    uint8_t data[8];
+} bench_frame_t;
+
+static bench_frame_t pool[POOL_SIZE];
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "dbc/emu_black.dbc";
+    long count = argc > 2 ? atol(argv[2]) : 20000000L;
+
+    // Startup cost
+    dbc_plan_t plan;
+    uint64_t best = UINT64_MAX, total = 0;
+    for (int run = 0; run < LOAD_RUNS; run++) {
+        uint64_t t0 = mono_time_ns();
+        if (!dbc_load(path, &plan)) return 1;
+        uint64_t dt = mono_time_ns() - t0;
+        total += dt;
+        if (dt < best) best = dt;
+        if (run < LOAD_RUNS - 1) dbc_free(&plan);
+    }
+    printf("dbc_load: %s: %d messages, %d ops, %d skipped\n",
+           path, plan.msg_count, plan.op_count, plan.skipped_signals);
+    printf("dbc_load: min %.1f us, avg %.1f us over %d runs\n",
+           (double)best / 1e3, (double)total / LOAD_RUNS / 1e3, LOAD_RUNS);
+
+    if (plan.msg_count == 0) {
+        printf("dbc_decode: plan is empty, nothing to measure\n");
+        return 0;
+    }
+
+    // Hot path: plan IDs plus a quarter foreign IDs
+    srand(1);
+    for (int i = 0; i < POOL_SIZE; i++) {
+        pool[i].id = (i % 4 == 3) ? 0x100u + (uint32_t)(rand() % 0x80)
+                                  : plan.msgs[rand() % plan.msg_count].can_id;
+        pool[i].dlc = 8;
+        for (int b = 0; b < 8; b++) pool[i].data[b] = (uint8_t)rand();
+    }
+
+    float values[CAN_CH_COUNT] = { 0 };
+    uint64_t touched = 0;
+    long decoded = 0;
+
+    uint64_t t0 = mono_time_ns();
+    for (long i = 0; i < count; i++) {
+        const bench_frame_t* f = &pool[i & (POOL_SIZE - 1)];
+        if (dbc_decode(&plan, f->id, f->dlc, f->data, values, &touched) == DBC_FRAME_DECODED) decoded++;
+    }
+    uint64_t t1 = mono_time_ns();
+
+    double secs = (double)(t1 - t0) / 1e9;
+    printf("dbc_decode: %ld frames (%ld decoded) in %.3f s\n", count, decoded, secs);
+    printf("dbc_decode: %.2f Mframes/s, %.1f ns/frame\n",
+           (double)count / secs / 1e6, (double)(t1 - t0) / (double)count);
+    printf("(touched %016llx)\n", (unsigned long long)touched);
+
+    dbc_free(&plan);
+    return 0;
+}
@@ -0,0 +1,69 @@
+// CPU cost of the flush copy that --flush lock removes: the rendered area is
+// copied row by row into a 720x720 ARGB8888 texture buffer, as
+// SDL_UpdateTexture does into the renderer's texture memory.
+// Usage: bench_flush_copy [frames]
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "util/mono_time.h"
+
+#define W 720
+#define H 720
+#define POOL 16     // Frames cycled through, 2 x 32 MB keeps the copies out of cache
+
+typedef struct {
+    const char* name;
+    int w, h;
+} area_t;
+
+// Whole frame (FULL mode), then typical partial refreshes of the gauges
+static const area_t areas[] = {
+    { "full screen 720x720", W, H },
+    { "RPM arc + digits 520x300", 520, 300 },
+    { "two readouts 360x120", 360, 120 },
+    { "one label 120x48", 120, 48 },
+};
+
+static volatile uint32_t sink;
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 2000;
+    if (frames < 1) frames = 1;
+
+    uint32_t* src = malloc((size_t)W * H * 4 * POOL);
+    uint32_t* dst = malloc((size_t)W * H * 4 * POOL);
+    if (!src || !dst) return 1;
+    for (size_t i = 0; i < (size_t)W * H * POOL; i++) src[i] = 0xFF000000u | (uint32_t)i;
+    memset(dst, 0, (size_t)W * H * 4 * POOL);
+
+    printf("BENCH: %d frames per area, destination pitch %d bytes\n", frames, W * 4);
+    for (size_t a = 0; a < sizeof(areas) / sizeof(areas[0]); a++) {
+        int w = areas[a].w, h = areas[a].h;
+        size_t row = (size_t)w * 4;
+
+        uint64_t t0 = mono_time_us();
+        for (int f = 0; f < frames; f++) {
+            // Move the area around so every frame touches fresh lines
+            int x = (f * 16) % (W - w + 1);
+            int y = (f * 8) % (H - h + 1);
+            size_t frame = (size_t)(f % POOL) * W * H;
+            const uint8_t* s = (const uint8_t*)(src + frame);
+            uint8_t* d = (uint8_t*)(dst + frame) + ((size_t)y * W + x) * 4;
+            for (int r = 0; r < h; r++) {
+                memcpy(d, s, row);
+                s += row;
+                d += (size_t)W * 4;
+            }
+            sink += dst[frame + (size_t)y * W + x];
+        }
+        double us = (double)(mono_time_us() - t0) / frames;
+        double bytes = (double)w * h * 4;
+        printf("BENCH: %-26s %7.1f KiB  %8.1f us/frame  %6.2f GB/s  %5.2f%% of a 60 fps frame\n",
+               areas[a].name, bytes / 1024.0, us, us > 0.0 ? bytes / us / 1e3 : 0.0, us / 16666.7 * 100.0);
+    }
+
+    free(src);
+    free(dst);
+    return 0;
+}
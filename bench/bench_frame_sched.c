@@ -0,0 +1,58 @@
+// Pacing accuracy of the frame scheduler: runs the deadline loop at a target
+// rate with a synthetic frame cost and prints lateness / jitter, next to a
+// naive "work, then sleep one period" loop for comparison.
+// Usage: bench_frame_sched [hz] [seconds] [work_ms]
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "util/frame_sched.h"
+#include "util/mono_time.h"
+
+static volatile uint64_t sink;
+
+static void busy_us(uint64_t us) {
+    uint64_t end = mono_time_us() + us;
+    while (mono_time_us() < end) sink++;
+}
+
+int main(int argc, char** argv) {
+    int hz = argc > 1 ? atoi(argv[1]) : 60;
+    int seconds = argc > 2 ? atoi(argv[2]) : 5;
+    double work_ms = argc > 3 ? atof(argv[3]) : 4.0;
+    if (hz < 1) hz = 1;
+    if (seconds < 1) seconds = 1;
+    int frames = hz * seconds;
+    uint64_t period_us = 1000000u / (uint64_t)hz;
+
+    printf("BENCH: %d Hz, %d frames, %.1f ms of work per frame (+/-50%%)\n", hz, frames, work_ms);
+    srand(1);
+
+    // Deadline scheduler
+    frame_sched_t s;
+    frame_sched_init(&s, hz);
+    for (int i = 0; i < frames; i++) {
+        frame_sched_wait(&s);
+        busy_us((uint64_t)(work_ms * (500.0 + rand() % 1000)));
+    }
+    frame_sched_print(&s, "BENCH: deadline: ");
+
+    // Naive relative sleep: the period stretches by the frame cost
+    histogram_t jitter;
+    histogram_reset(&jitter);
+    uint64_t last = 0;
+    uint64_t t0 = mono_time_us();
+    for (int i = 0; i < frames; i++) {
+        uint64_t now = mono_time_us();
+        if (last) {
+            uint64_t iv = now - last;
+            histogram_add(&jitter, iv > period_us ? iv - period_us : period_us - iv);
+        }
+        last = now;
+        busy_us((uint64_t)(work_ms * (500.0 + rand() % 1000)));
+        struct timespec ts = { 0, (long)period_us * 1000L };
+        nanosleep(&ts, NULL);
+    }
+    printf("BENCH: relative sleep: %.2f Hz achieved\n", (double)frames * 1e6 / (double)(mono_time_us() - t0));
+    histogram_print(&jitter, "BENCH: relative sleep: ", "frame interval jitter", 1000.0, "ms");
+    return 0;
+}
@@ -0,0 +1,117 @@
+// Writer cost of the channel history rings with 0..3 concurrent readers.
+// Readers poll every channel as fast as they can (far harder than the UI) and
+// check that the RPM samples they get are contiguous and in time order.
+// Usage: bench_history [pushes]
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "can/can_history.h"
+#include "util/mono_time.h"
+
+#define MAX_READERS 3
+
+// Channels one EMU frame updates (frame 0 / frame 2 mix)
+static const can_channel_t frame_channels[] = {
+    CAN_CH_RPM, CAN_CH_TPS, CAN_CH_IAT, CAN_CH_MAP, CAN_CH_BOOST, CAN_CH_INJ_PW,
+};
+#define FRAME_CHANNELS (int)(sizeof(frame_channels) / sizeof(frame_channels[0]))
+
+static atomic_bool stop = false;
+
+// Writer cost is its own CPU time, so readers sharing a core do not count
+static uint64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+typedef struct {
+    pthread_t thread;
+    uint64_t samples;
+    uint64_t lost;
+    uint64_t errors;
+    uint64_t reads;
+} reader_t;
+
+static void* reader_main(void* arg) {
+    reader_t* rd = arg;
+    static _Thread_local can_history_sample_t buf[1024];
+    can_history_cursor_t cur[CAN_CH_COUNT] = { 0 };
+    float last_rpm = -1.0f;
+    uint64_t last_stamp = 0;
+
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        for (int ch = 0; ch < CAN_CH_COUNT; ch++) {
+            uint64_t lost_before = cur[ch].lost;
+            int n = can_history_read((can_channel_t)ch, &cur[ch], buf, 1024);
+            rd->reads++;
+            rd->samples += (uint64_t)n;
+            if (ch != CAN_CH_RPM) continue;
+
+            // A gap is fine if it was reported as lost
+            if (cur[ch].lost != lost_before) last_rpm = -1.0f;
+            for (int i = 0; i < n; i++) {
+                if (last_rpm >= 0.0f && buf[i].value != (last_rpm >= 9999.0f ? 0.0f : last_rpm + 1.0f)) rd->errors++;
+                if (buf[i].stamp_us < last_stamp) rd->errors++;
+                last_rpm = buf[i].value;
+                last_stamp = buf[i].stamp_us;
+            }
+        }
+    }
+    for (int ch = 0; ch < CAN_CH_COUNT; ch++) rd->lost += cur[ch].lost;
+    return NULL;
+}
+
+static double run(int readers, long pushes) {
+    static uint64_t base_us = 1000000;
+    reader_t rd[MAX_READERS] = { 0 };
+
+    can_history_init(CAN_HISTORY_DEFAULT_SECONDS, (size_t)CAN_HISTORY_DEFAULT_BUDGET_KB * 1024);
+    atomic_store(&stop, false);
+    for (int i = 0; i < readers; i++) pthread_create(&rd[i].thread, NULL, reader_main, &rd[i]);
+
+    // Simulated receive clock: one frame every 222 us (full 500 kbit/s bus)
+    uint64_t t0 = thread_cpu_ns();
+    uint64_t w0 = mono_time_ns();
+    for (long i = 0; i < pushes; i++) {
+        uint64_t ts = base_us + (uint64_t)i * 222u;
+        for (int c = 0; c < FRAME_CHANNELS; c++) {
+            float v = c == 0 ? (float)(i % 10000) : (float)(i & 63);
+            can_history_push(frame_channels[c], v, ts);
+        }
+    }
+    uint64_t t1 = thread_cpu_ns();
+    uint64_t w1 = mono_time_ns();
+    base_us += (uint64_t)pushes * 222u;
+
+    atomic_store(&stop, true);
+    uint64_t samples = 0, lost = 0, errors = 0, reads = 0;
+    for (int i = 0; i < readers; i++) {
+        pthread_join(rd[i].thread, NULL);
+        samples += rd[i].samples;
+        lost += rd[i].lost;
+        errors += rd[i].errors;
+        reads += rd[i].reads;
+    }
+
+    double ns = (double)(t1 - t0) / ((double)pushes * FRAME_CHANNELS);
+    printf("history: %d readers: %.2f ns/push writer CPU (%ld frames in %.3f s wall), readers %llu reads, %llu samples, %llu lost, %llu errors\n",
+           readers, ns, pushes, (double)(w1 - w0) / 1e9, (unsigned long long)reads, (unsigned long long)samples,
+           (unsigned long long)lost, (unsigned long long)errors);
+    can_history_free();
+    return ns;
+}
+
+int main(int argc, char** argv) {
+    long pushes = argc > 1 ? atol(argv[1]) : 20000000L;
+
+    run(0, pushes / 10);   // Warm up
+    double base = run(0, pushes);
+    for (int r = 1; r <= MAX_READERS; r++) {
+        double ns = run(r, pushes);
+        printf("history: %d readers: %.2fx the unloaded writer cost\n", r, ns / base);
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+// Ingest-path cost of the flight recorder while its writer thread is
+// draining to disk. Frames are pushed in batches at full 500 kbit/s bus rate
+// (like the CAN thread would), then flat out; every push is timed.
+// Usage: bench_recorder [dir] [seconds]
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "can/can_recorder.h"
+#include "util/histogram.h"
+#include "util/mono_time.h"
+
+#define BUS_FPS 4500
+#define BATCH   16
+
+static histogram_t push_ns;
+static histogram_t timer_ns;
+
+static void push_timed(uint32_t id, const uint8_t* data) {
+    uint64_t t0 = mono_time_ns();
+    can_recorder_push(id, 8, data, t0 / 1000);
+    histogram_add(&push_ns, mono_time_ns() - t0);
+}
+
+int main(int argc, char** argv) {
+    const char* dir = argc > 1 ? argv[1] : "/tmp";
+    int seconds = argc > 2 ? atoi(argv[2]) : 5;
+
+    // Timer overhead, to read the push numbers against
+    histogram_reset(&timer_ns);
+    for (int i = 0; i < 100000; i++) {
+        uint64_t t0 = mono_time_ns();
+        histogram_add(&timer_ns, mono_time_ns() - t0);
+    }
+
+    if (!can_recorder_start(dir, "bench0", CAN_RECORDER_DEFAULT_RING_KB, CAN_RECORDER_DEFAULT_SYNC_MS, 0)) return 1;
+
+    uint8_t data[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint32_t n = 0;
+
+    // Paced: one batch every BATCH / BUS_FPS seconds
+    histogram_reset(&push_ns);
+    uint64_t period_ns = 1000000000ull * BATCH / BUS_FPS;
+    uint64_t end = mono_time_ns() + (uint64_t)seconds * 1000000000ull;
+    uint64_t next = mono_time_ns();
+    while (next < end) {
+        for (int i = 0; i < BATCH; i++, n++) {
+            data[0] = (uint8_t)n;
+            push_timed(0x600u + (n & 7), data);
+        }
+        next += period_ns;
+        uint64_t now = mono_time_ns();
+        if (next > now) {
+            struct timespec ts = { (time_t)((next - now) / 1000000000ull), (long)((next - now) % 1000000000ull) };
+            nanosleep(&ts, NULL);
+        }
+    }
+    histogram_print(&timer_ns, "recorder: ", "timer overhead", 1.0, "ns");
+    histogram_print(&push_ns, "recorder: ", "push at bus rate", 1.0, "ns");
+
+    // Flat out: the ring fills faster than any SD card; pushes must stay cheap and drop
+    histogram_reset(&push_ns);
+    for (long i = 0; i < 2000000; i++, n++) push_timed(0x600u + (n & 7), data);
+    histogram_print(&push_ns, "recorder: ", "push flat out", 1.0, "ns");
+
+    can_recorder_stop();
+    can_recorder_print_stats();
+    return 0;
+}
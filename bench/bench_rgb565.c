@@ -0,0 +1,105 @@
+// Per-frame CPU cost of the --color options on the flush side: copying a
+// full 720x720 frame as ARGB8888 (8888) or RGB565 (565) into the texture,
+// and converting ARGB8888 to RGB565 with and without the ordered dither
+// (565-dither). Also prints the buffer sizes of each pipeline.
+// Usage: bench_rgb565 [frames]
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "util/mono_time.h"
+#include "util/rgb565.h"
+
+#define W 720
+#define H 720
+#define POOL 16     // Frames cycled through so the copies miss the cache
+
+static volatile uint32_t sink;
+
+static void copy_frame(uint8_t* d, const uint8_t* s, int px_size) {
+    memcpy(d, s, (size_t)W * H * px_size);
+}
+
+static void report(const char* name, uint64_t t0, int frames, double bytes_out) {
+    double us = (double)(mono_time_us() - t0) / frames;
+    printf("BENCH: %-28s %8.1f us/frame  %6.2f GB/s written  %5.2f%% of a 60 fps frame\n",
+           name, us, us > 0.0 ? bytes_out / us / 1e3 : 0.0, us / 16666.7 * 100.0);
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 500;
+    if (frames < 1) frames = 1;
+
+    size_t frame32 = (size_t)W * H * 4;
+    size_t frame16 = (size_t)W * H * 2;
+    uint8_t* src32 = malloc(frame32 * POOL);
+    uint8_t* src16 = malloc(frame16 * POOL);
+    uint8_t* dst = malloc(frame32 * POOL);
+    if (!src32 || !src16 || !dst) return 1;
+    // Dark vertical gradient, the case the dither is for
+    for (size_t f = 0; f < POOL; f++) {
+        uint32_t* p = (uint32_t*)(src32 + f * frame32);
+        for (int y = 0; y < H; y++) {
+            uint32_t v = (uint32_t)(y * 0x30 / H);
+            for (int x = 0; x < W; x++) p[y * W + x] = 0xFF000000u | (v << 16) | (v << 8) | (v + (uint32_t)(x & 1));
+        }
+    }
+    memset(src16, 0x21, frame16 * POOL);
+    memset(dst, 0, frame32 * POOL);
+
+    printf("BENCH: %d frames of %dx%d\n", frames, W, H);
+    printf("BENCH: frame %zu KiB (8888) / %zu KiB (565); partial draw buffers 2 x %zu / 2 x %zu KiB "
+           "(1/10 screen); DRM 3 x %zu / 3 x %zu KiB\n",
+           frame32 / 1024, frame16 / 1024, frame32 / 10 / 1024, frame16 / 10 / 1024,
+           frame32 / 1024, frame16 / 1024);
+
+    uint64_t t0 = mono_time_us();
+    for (int f = 0; f < frames; f++) copy_frame(dst + (f % POOL) * frame32, src32 + (f % POOL) * frame32, 4);
+    report("copy 8888", t0, frames, (double)frame32);
+
+    t0 = mono_time_us();
+    for (int f = 0; f < frames; f++) copy_frame(dst + (f % POOL) * frame16, src16 + (f % POOL) * frame16, 2);
+    report("copy 565", t0, frames, (double)frame16);
+
+    t0 = mono_time_us();
+    for (int f = 0; f < frames; f++)
+        rgb565_convert(src32 + (f % POOL) * frame32, W * 4, (uint16_t*)(dst + (f % POOL) * frame16), W * 2,
+                       W, H, 0, 0, false);
+    report("convert 8888 -> 565", t0, frames, (double)frame16);
+
+    t0 = mono_time_us();
+    for (int f = 0; f < frames; f++)
+        rgb565_convert(src32 + (f % POOL) * frame32, W * 4, (uint16_t*)(dst + (f % POOL) * frame16), W * 2,
+                       W, H, 0, 0, true);
+    report("convert 8888 -> 565 dither", t0, frames, (double)frame16);
+
+    // Distinct grey levels left in the dark gradient, first column
+    int levels_plain = 0, levels_dither = 0;
+    uint16_t line[W];
+    uint32_t last_plain = 0xFFFFFFFF;
+    for (int y = 0; y < H; y++) {
+        rgb565_convert(src32 + (size_t)y * W * 4, W * 4, line, W * 2, W, 1, 0, y, false);
+        if (line[0] != last_plain) levels_plain++;
+        last_plain = line[0];
+    }
+    // Dithered: average of a 4x4 cell, i.e. the shade the eye sees
+    double last_avg = -1.0;
+    uint16_t cell[4][W];
+    for (int y = 0; y + 4 <= H; y += 4) {
+        for (int r = 0; r < 4; r++)
+            rgb565_convert(src32 + (size_t)(y + r) * W * 4, W * 4, cell[r], W * 2, W, 1, 0, y + r, true);
+        double avg = 0.0;
+        for (int r = 0; r < 4; r++)
+            for (int x = 0; x < 4; x++) avg += (cell[r][x] >> 5) & 0x3F;
+        if (avg != last_avg) levels_dither++;
+        last_avg = avg;
+    }
+    printf("BENCH: dark gradient 0x00..0x30: %d bands plain, %d perceived steps dithered (per 4 rows)\n",
+           levels_plain, levels_dither);
+
+    sink += dst[0];
+    free(src32);
+    free(src16);
+    free(dst);
+    return 0;
+}
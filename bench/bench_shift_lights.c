@@ -0,0 +1,97 @@
+// Shift light frame: the compiled rpm-bucket table against the if-chain it
+// replaced, over an rpm sweep. Also compares the frames of the built-in
+// profile with the old chain outside the blink (the only differences
+// expected are at the thresholds themselves, lit from there now), and with
+// a profile file given, prints its frames every 250 rpm per gear and coolant
+// temperature.
+// Usage: bench_shift_lights [iterations] [profile]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "util/mono_time.h"
+#include "hardware/led_logic.h"
+
+static volatile uint8_t sink;
+
+// The chain this replaced, minus the blink
+static void shift_lights_legacy(int rpm, led_color_t* leds) {
+    memset(leds, 0, SHIFT_LIGHT_LEDS * sizeof(led_color_t));
+    int leds_active = 0;
+    if (rpm > 4000) leds_active = 1;
+    if (rpm > 4500) leds_active = 2;
+    if (rpm > 5000) leds_active = 3;
+    if (rpm > 5500) leds_active = 4;
+    if (rpm > 6000) leds_active = 5;
+    if (rpm > 6500) leds_active = 6;
+    if (rpm > 7000) leds_active = 7;
+    if (rpm > 7500) leds_active = 8;
+    for (int i = 0; i < leds_active; i++) {
+        if (i < 4) {
+            leds[i].r = 0; leds[i].g = 100; leds[i].b = 0;
+        } else if (i < 6) {
+            leds[i].r = 100; leds[i].g = 100; leds[i].b = 100;
+        } else {
+            leds[i].r = 200; leds[i].g = 0; leds[i].b = 0;
+        }
+    }
+}
+
+static void print_frame(const led_color_t* leds) {
+    for (int i = 0; i < SHIFT_LIGHT_LEDS; i++) {
+        const led_color_t* c = &leds[i];
+        putchar(!c->r && !c->g && !c->b ? '.' : c->r && c->g && c->b ? 'W' : c->r ? 'R' : c->g ? 'G' : 'B');
+    }
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 100;
+    if (iterations < 1) iterations = 1;
+    led_color_t a[SHIFT_LIGHT_LEDS], b[SHIFT_LIGHT_LEDS];
+
+    // Built-in profile against the old chain, below the redline
+    int differ = 0;
+    for (int rpm = 0; rpm < 8000; rpm++) {
+        calculate_shift_lights(rpm, 0, SHIFT_LIGHT_CLT_UNKNOWN, a);
+        shift_lights_legacy(rpm, b);
+        if (memcmp(a, b, sizeof(a)) != 0) differ++;
+    }
+    printf("BENCH: built-in profile vs old chain: %d of 8000 rpm values differ\n", differ);
+
+    uint64_t t0 = mono_time_ns();
+    for (int it = 0; it < iterations; it++) {
+        for (int rpm = 0; rpm < 10000; rpm++) {
+            shift_lights_legacy(rpm, a);
+            sink ^= a[rpm & 7].g;
+        }
+    }
+    double legacy_ns = (double)(mono_time_ns() - t0) / ((double)iterations * 10000.0);
+
+    t0 = mono_time_ns();
+    for (int it = 0; it < iterations; it++) {
+        for (int rpm = 0; rpm < 10000; rpm++) {
+            calculate_shift_lights(rpm, rpm & 7, 80, a);
+            sink ^= a[rpm & 7].g;
+        }
+    }
+    double table_ns = (double)(mono_time_ns() - t0) / ((double)iterations * 10000.0);
+    printf("BENCH: per frame: if-chain %.1f ns, table %.1f ns (with gear, coolant and blink)\n", legacy_ns, table_ns);
+
+    if (argc > 2) {
+        if (!shift_lights_load(argv[2])) return 1;
+        static const int clts[] = { 20, 50, 90 };
+        for (int g = 0; g <= 3; g++) {
+            for (int c = 0; c < 3; c++) {
+                printf("BENCH: gear %d CLT %2d: ", g, clts[c]);
+                for (int rpm = 3000; rpm <= 9000; rpm += 250) {
+                    // Blink on phase only, so the frames do not depend on the clock
+                    do calculate_shift_lights(rpm, g, clts[c], a);
+                    while (mono_time_us() % 150000 >= 75000);
+                    print_frame(a);
+                    putchar(' ');
+                }
+                putchar('\n');
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,166 @@
+// WS2812 SPI encoder: time per update of the 2.4 MHz lookup-table encoder
+// against the previous 6 MHz one-byte-per-bit loop, then a check of the
+// bitstream itself. The encoded SPI bits are turned back into line levels at
+// several SPI clocks, every high/low pulse is measured and classified against
+// the WS2812B datasheet windows, and the decoded GRB bytes must match the
+// input. Exits 1 if any pulse is out of tolerance or a byte differs.
+// Usage: bench_ws2812 [iterations]
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "util/mono_time.h"
+#include "hardware/ws2812_encode.h"
+
+#define MAX_LEDS 300
+
+// WS2812B datasheet, +-150 ns on every phase
+#define T0H_MIN 250
+#define T0H_MAX 550
+#define T1H_MIN 650
+#define T1H_MAX 950
+#define T0L_MIN 700
+#define T0L_MAX 1000
+#define T1L_MIN 300
+#define T1L_MAX 600
+#define RESET_MIN_NS 50000
+
+static volatile uint8_t sink;
+
+// The encoder this replaced: one SPI byte per data bit at 6 MHz, 60 reset bytes
+static size_t encode_legacy(const led_color_t* colors, int n, uint8_t* out) {
+    size_t idx = 0;
+    for (int i = 0; i < n; i++) {
+        uint8_t bytes[3] = { colors[i].g, colors[i].r, colors[i].b };
+        for (int b = 0; b < 3; b++)
+            for (int bit = 7; bit >= 0; bit--) out[idx++] = ((bytes[b] >> bit) & 1) ? 0xF8 : 0xE0;
+    }
+    for (int k = 0; k < 60; k++) out[idx++] = 0x00;
+    return idx;
+}
+
+static void time_encoders(int num_leds, int iterations, led_color_t* colors, uint8_t* buf) {
+    uint64_t t0 = mono_time_ns();
+    size_t legacy_len = 0;
+    for (int i = 0; i < iterations; i++) {
+        colors[0].g = (uint8_t)i;
+        legacy_len = encode_legacy(colors, num_leds, buf);
+        sink += buf[i % legacy_len];
+    }
+    double legacy_ns = (double)(mono_time_ns() - t0) / iterations;
+
+    t0 = mono_time_ns();
+    for (int i = 0; i < iterations; i++) {
+        colors[0].g = (uint8_t)i;
+        ws2812_encode(colors, num_leds, buf);
+        sink += buf[i % ws2812_encoded_size(num_leds)];
+    }
+    double lut_ns = (double)(mono_time_ns() - t0) / iterations;
+    size_t lut_len = ws2812_encoded_size(num_leds);
+
+    printf("BENCH: %3d LEDs  6 MHz loop %5zu B %8.0f ns %6.1f us on the wire | "
+           "2.4 MHz LUT %5zu B %8.0f ns %6.1f us on the wire | %.1fx less CPU, %.1fx fewer bytes\n",
+           num_leds, legacy_len, legacy_ns, legacy_len * 8 / 6.0,
+           lut_len, lut_ns, lut_len * 8 / 2.4,
+           lut_ns > 0.0 ? legacy_ns / lut_ns : 0.0, (double)legacy_len / (double)lut_len);
+}
+
+// Decode the MOSI bitstream sent at spi_hz; returns false on any violation
+static bool decode_check(const uint8_t* spi, size_t len, double spi_hz,
+                         const led_color_t* expect, int num_leds, double* worst_margin_ns) {
+    double bit_ns = 1e9 / spi_hz;
+    size_t nbits = len * 8;
+    size_t pos = 0;
+    int decoded = 0;            // Data bits decoded
+    uint8_t byte = 0;
+    int led = 0, channel = 0;
+    bool ok = true;
+
+    while (pos < nbits) {
+        size_t h = 0, l = 0;
+        while (pos < nbits && ((spi[pos / 8] >> (7 - pos % 8)) & 1)) { h++; pos++; }
+        while (pos < nbits && !((spi[pos / 8] >> (7 - pos % 8)) & 1)) { l++; pos++; }
+        if (h == 0) {
+            // Only the low tail left: the reset
+            if (l * bit_ns < RESET_MIN_NS) ok = false;
+            break;
+        }
+        double th = h * bit_ns, tl = l * bit_ns;
+        bool last = pos >= nbits;
+        int bit;
+        if (th >= T0H_MIN && th <= T0H_MAX) {
+            bit = 0;
+            if (!last && (tl < T0L_MIN || tl > T0L_MAX)) ok = false;
+            double m = th - T0H_MIN < T0H_MAX - th ? th - T0H_MIN : T0H_MAX - th;
+            if (m < *worst_margin_ns) *worst_margin_ns = m;
+        } else if (th >= T1H_MIN && th <= T1H_MAX) {
+            bit = 1;
+            if (!last && (tl < T1L_MIN || tl > T1L_MAX)) ok = false;
+            double m = th - T1H_MIN < T1H_MAX - th ? th - T1H_MIN : T1H_MAX - th;
+            if (m < *worst_margin_ns) *worst_margin_ns = m;
+        } else {
+            ok = false;
+            break;
+        }
+        // The low phase of the last bit of the frame runs into the reset
+        if (decoded % 24 == 23 && led == num_leds - 1) {
+            if (tl < RESET_MIN_NS) ok = false;
+        }
+
+        byte = (uint8_t)((byte << 1) | bit);
+        if (++decoded % 8 == 0) {
+            uint8_t want = channel == 0 ? expect[led].g : channel == 1 ? expect[led].r : expect[led].b;
+            if (byte != want) ok = false;
+            if (++channel == 3) {
+                channel = 0;
+                led++;
+            }
+        }
+    }
+    return ok && led == num_leds && decoded == num_leds * 24;
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 200000;
+    if (iterations < 1) iterations = 1;
+
+    led_color_t* colors = malloc(sizeof(led_color_t) * MAX_LEDS);
+    uint8_t* buf = malloc((size_t)MAX_LEDS * 24 + 64);
+    if (!colors || !buf) return 1;
+    srand(1);
+    for (int i = 0; i < MAX_LEDS; i++) {
+        colors[i].r = (uint8_t)rand();
+        colors[i].g = (uint8_t)rand();
+        colors[i].b = (uint8_t)rand();
+    }
+
+    printf("BENCH: %d encodes per size\n", iterations);
+    time_encoders(8, iterations, colors, buf);
+    time_encoders(60, iterations / 8, colors, buf);
+    time_encoders(MAX_LEDS, iterations / 32, colors, buf);
+
+    // Edge patterns first (all 0, all 1, alternating), then random colours
+    static const uint8_t patterns[] = { 0x00, 0xFF, 0xAA, 0x55, 0x80, 0x01 };
+    for (size_t p = 0; p < sizeof(patterns); p++) {
+        colors[p].r = colors[p].g = colors[p].b = patterns[p];
+    }
+    ws2812_encode(colors, MAX_LEDS, buf);
+
+    // Nominal clock, the Pi 5 RP1 divider result (200 MHz / 84) and +-6%
+    static const double clocks[] = { 2400000.0, 200e6 / 84, 2256000.0, 2544000.0 };
+    int failures = 0;
+    for (size_t c = 0; c < sizeof(clocks) / sizeof(clocks[0]); c++) {
+        double margin = 1e9;
+        bool ok = decode_check(buf, ws2812_encoded_size(MAX_LEDS), clocks[c], colors, MAX_LEDS, &margin);
+        printf("BENCH: decode at %.3f MHz: %s, %d LEDs, T0H %.0f ns T1H %.0f ns, "
+               "closest high time to a datasheet limit %.0f ns\n",
+               clocks[c] / 1e6, ok ? "OK" : "FAILED", MAX_LEDS,
+               1e9 / clocks[c], 2e9 / clocks[c], margin);
+        if (!ok) failures++;
+    }
+
+    free(colors);
+    free(buf);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,68 @@
+// WS2812 update time against LED count, on the real SPI devices. For each
+// length the LEDs are split evenly over the given spidev devices (one
+// strip each, sent in parallel) and ws2812_update() is timed over a number
+// of frames. The wire time is what the bits alone take at the SPI clock
+// for the longest strip; the difference is ioctl, DMA setup and, on strips
+// longer than spidev's bufsiz, the pauses between chunks.
+// Usage: bench_ws2812_update [frames] [DEV]...   (default /dev/spidev0.0)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "util/mono_time.h"
+#include "util/histogram.h"
+#include "hardware/ws2812_driver.h"
+#include "hardware/ws2812_encode.h"
+
+static const int led_counts[] = { 8, 60, 144, 300, 600, 1000 };
+#define NUM_COUNTS ((int)(sizeof(led_counts) / sizeof(led_counts[0])))
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 500;
+    if (frames < 1) frames = 1;
+
+    ws2812_strip_t strips[WS2812_MAX_STRIPS];
+    int num_strips = 0;
+    for (int i = 2; i < argc && num_strips < WS2812_MAX_STRIPS; i++) strips[num_strips++].device = argv[i];
+    if (num_strips == 0) strips[num_strips++].device = "/dev/spidev0.0";
+
+    led_color_t* colors = malloc(1000 * sizeof(led_color_t));
+    if (!colors) return 1;
+
+    printf("BENCH: %d frames per length, %d strip%s\n", frames, num_strips, num_strips > 1 ? "s in parallel" : "");
+    for (int c = 0; c < NUM_COUNTS; c++) {
+        int total = led_counts[c];
+        int longest = (total + num_strips - 1) / num_strips;
+        for (int s = 0; s < num_strips; s++) strips[s].num_leds = total / num_strips + (s < total % num_strips);
+        if (!ws2812_init_strips(strips, num_strips)) {
+            printf("BENCH: cannot open the SPI devices.\n");
+            return 1;
+        }
+
+        histogram_t h;
+        histogram_reset(&h);
+        for (int f = 0; f < frames; f++) {
+            // A new frame every time, as the shift lights do while blinking
+            for (int i = 0; i < total; i++) {
+                colors[i].r = (uint8_t)(f + i);
+                colors[i].g = (uint8_t)(f * 3 + i);
+                colors[i].b = (uint8_t)(f * 7 + i);
+            }
+            uint64_t t0 = mono_time_us();
+            ws2812_update(colors);
+            histogram_add(&h, mono_time_us() - t0);
+        }
+
+        double wire_us = (double)ws2812_encoded_size(longest) * 8.0 * 1e6 / WS2812_SPI_HZ;
+        printf("BENCH: %4d LEDs: %zu bytes per strip, wire time %.0f us, update avg %.0f us p99 %llu us max %llu us\n",
+               total, ws2812_encoded_size(longest), wire_us, (double)h.sum / (double)h.count,
+               (unsigned long long)histogram_percentile(&h, 99.0), (unsigned long long)h.max);
+        ws2812_print_stats();
+
+        // All off before the next length
+        memset(colors, 0, (size_t)total * sizeof(led_color_t));
+        ws2812_update(colors);
+        ws2812_close();
+    }
+    free(colors);
+    return 0;
+}
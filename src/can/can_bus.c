@@ -1,20 +1,88 @@
+#define _GNU_SOURCE // recvmmsg, ppoll
 #include "can_bus.h"
+#include "emu_decoder.h"
+#include "dbc_loader.h"
+#include "can_history.h"
+#include "can_recorder.h"
 #include <SDL.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdatomic.h>
+#include "../util/mono_time.h"
 
 // --- SHARED DATA STORE ---
-static volatile int current_rpm = 0;
-static volatile int current_speed = 0;
-static volatile float current_boost = 0.0f;
-static volatile float current_oil_press = 0.0f; // Changed to float
-static volatile int current_clt = 0;
-static volatile int current_oil_t = 0;
-static volatile int current_egt = 0;
-static volatile int current_iat = 0;
+// Seqlock: the CAN thread decodes into its private working copy and then
+// publishes the whole snapshot. The sequence counter is odd while a publish
+// is in progress; readers retry if they see an odd or changed counter, so the
+// writer never waits on the UI.
+static can_snapshot_t shared_snap;
+static atomic_uint snap_seq = 0;
 
-static SDL_mutex* data_mutex = NULL;
+static atomic_uint stat_reads = 0;
+static atomic_uint stat_retries = 0;
+
+// Ingest counters, written by the CAN thread only
+static atomic_ullong stat_frames = 0;
+static atomic_ullong stat_batches = 0;
+static atomic_ullong stat_syscalls = 0;
+static atomic_uint stat_max_batch = 0;
+static atomic_ullong stat_start_us = 0;
+
+static atomic_uint stat_rx_overflow = 0;
+static atomic_uint stat_bad_dlc = 0;
+
+// Batching (see can_set_batch)
+static int batch_frames = CAN_BATCH_DEFAULT;
+static int batch_wait_us = 0;
+
+// Frame decoder. The kernel receive filter is generated from the IDs it
+// consumes plus the extra IDs.
+static uint32_t emu_base = EMU_DEFAULT_BASE;
+static emu_decoder_t emu;
+
+// Optional DBC decode plan, consulted before the built-in EMU table
+static dbc_plan_t dbc;
+static bool dbc_loaded = false;
+
+// Channels with no update for this long are reported stale
+static uint64_t stale_timeout_us = 1000000;
+
+#define CAN_EXTRA_IDS_MAX 32
+static uint32_t extra_ids[CAN_EXTRA_IDS_MAX];
+static int extra_id_count = 0;
+static bool filtering_enabled = true;
+
+// New-data notification for the render loop (see can_set_notify_event)
+static uint32_t notify_event = 0;
+static atomic_bool notify_pending = false;
+
+// Working copy, only touched by the CAN thread
+static can_snapshot_t work;
+
+static void notify_ui(void) {
+    if (!notify_event) return;
+    // Coalesce: a burst of publishes wakes the loop once, it reads the latest
+    if (atomic_exchange_explicit(&notify_pending, true, memory_order_acq_rel)) return;
+
+    SDL_Event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = notify_event;
+    if (SDL_PushEvent(&ev) != 1) atomic_store_explicit(&notify_pending, false, memory_order_release);
+}
+
+static void publish_snapshot(void) {
+    unsigned int seq = atomic_load_explicit(&snap_seq, memory_order_relaxed);
+
+    atomic_store_explicit(&snap_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    work.seq = seq + 2;
+    shared_snap = work;
+
+    atomic_store_explicit(&snap_seq, seq + 2, memory_order_release);
+    notify_ui();
+}
 
 // Helper to clamp values
 static float clamp_f(float val, float min, float max) {
@@ -23,37 +91,325 @@ static float clamp_f(float val, float min, float max) {
     return val;
 }
 
-static int clamp_i(int val, int min, int max) {
-    if (val < min) return min;
-    if (val > max) return max;
-    return val;
+// Record the receive time of every channel in mask and append the new
+// values to the history rings
+static void stamp_channels(uint64_t mask, uint64_t ts_us) {
+    while (mask) {
+        int ch = __builtin_ctzll(mask);
+        mask &= mask - 1;
+        work.stamp_us[ch] = ts_us;
+        can_history_push((can_channel_t)ch, work.values[ch], ts_us);
+    }
+}
+
+static void count_batch(int frames, int syscalls) {
+    atomic_fetch_add_explicit(&stat_syscalls, (unsigned long long)syscalls, memory_order_relaxed);
+    if (frames <= 0) return;
+    atomic_fetch_add_explicit(&stat_frames, (unsigned long long)frames, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stat_batches, 1, memory_order_relaxed);
+    if ((unsigned int)frames > atomic_load_explicit(&stat_max_batch, memory_order_relaxed))
+        atomic_store_explicit(&stat_max_batch, (unsigned int)frames, memory_order_relaxed);
+}
+
+void can_set_batch(int max_frames, int max_wait_us) {
+    if (max_frames < 1) max_frames = 1;
+    if (max_frames > CAN_BATCH_MAX) max_frames = CAN_BATCH_MAX;
+    if (max_wait_us < 0) max_wait_us = 0;
+    batch_frames = max_frames;
+    batch_wait_us = max_wait_us;
+}
+
+void can_set_notify_event(uint32_t sdl_event_type) {
+    notify_event = sdl_event_type;
+}
+
+void can_notify_ack(void) {
+    atomic_store_explicit(&notify_pending, false, memory_order_release);
+}
+
+void can_set_stale_timeout_ms(int ms) {
+    if (ms < 1) ms = 1;
+    stale_timeout_us = (uint64_t)ms * 1000u;
+}
+
+can_status_t can_channel_status(const can_snapshot_t* snap, can_channel_t ch, uint64_t now_us) {
+    uint64_t ts = snap->stamp_us[ch];
+    if (ts == 0) return CAN_STATUS_WAITING;
+    if (now_us > ts && now_us - ts > stale_timeout_us) return CAN_STATUS_STALE;
+    return CAN_STATUS_FRESH;
+}
+
+void can_set_emu_base(uint32_t base) {
+    emu_base = base;
+}
+
+bool can_load_dbc(const char* path) {
+    if (dbc_loaded) dbc_free(&dbc);
+    dbc_loaded = false;
+
+    uint64_t t0 = mono_time_us();
+    if (!dbc_load(path, &dbc)) return false;
+    uint64_t t1 = mono_time_us();
+
+    dbc_loaded = true;
+    printf("DBC: %s: %d messages, %d signals mapped, %d skipped (%llu us)\n",
+           path, dbc.msg_count, dbc.op_count, dbc.skipped_signals,
+           (unsigned long long)(t1 - t0));
+    return true;
+}
+
+bool can_add_filter_id(uint32_t id) {
+    if (extra_id_count >= CAN_EXTRA_IDS_MAX) return false;
+    extra_ids[extra_id_count++] = id;
+    return true;
+}
+
+void can_set_filtering(bool enabled) {
+    filtering_enabled = enabled;
+}
+
+// Per-ID arrival statistics (SocketCAN section; a no-op in simulation)
+static void track_id_timing(uint32_t can_id, uint64_t ts_us);
+
+static void init_decoder(void) {
+    emu_decoder_init(&emu, emu_base);
+}
+
+// Decode one frame into the working copy. Returns the channels it updated.
+static uint64_t decode_frame(uint32_t can_id, uint8_t dlc, const uint8_t* data, uint64_t ts_us) {
+    uint64_t touched = 0;
+    bool bad_dlc = false;
+
+    // DBC messages override the built-in table for their IDs
+    dbc_result_t r = dbc_loaded
+        ? dbc_decode(&dbc, can_id, dlc, data, work.values, &touched)
+        : DBC_FRAME_IGNORED;
+    if (r == DBC_FRAME_IGNORED) {
+        bad_dlc = emu_decode(&emu, can_id, dlc, data, work.values, &touched) == EMU_FRAME_BAD_DLC;
+    } else {
+        bad_dlc = (r == DBC_FRAME_BAD_DLC);
+    }
+    if (bad_dlc) atomic_fetch_add_explicit(&stat_bad_dlc, 1, memory_order_relaxed);
+
+    if (touched) {
+        stamp_channels(touched, ts_us);
+        track_id_timing(can_id, ts_us);
+    }
+    return touched;
+}
+
+// --- INJECTED FRAMES (replay) ---
+bool can_init_replay(void) {
+    init_decoder();
+    atomic_store_explicit(&stat_start_us, mono_time_us(), memory_order_relaxed);
+    printf("CAN: no interface, decoding replayed frames.\n");
+    return true;
+}
+
+uint64_t can_inject_frame(uint32_t can_id, uint8_t dlc, const uint8_t* data, uint64_t ts_us) {
+    uint64_t touched = decode_frame(can_id, dlc, data, ts_us);
+    if (touched && ts_us > work.rx_us) work.rx_us = ts_us;
+    return touched;
+}
+
+void can_inject_publish(int frames, uint64_t touched) {
+    if (touched) publish_snapshot();
+    count_batch(frames, 0);
 }
 
 // --- LINUX / SOCKETCAN ---
 #ifdef __linux__
+#include <errno.h>
+#include <poll.h>
 #include <unistd.h>
 #include <net/if.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <linux/can.h>
 #include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+#include <linux/errqueue.h>
+#include <pthread.h>
+#include <time.h>
 
 static int s_socket = -1;
+static bool kernel_ts = false;
+static char if_name[IFNAMSIZ];
+static uint64_t if_rx_base = 0;
+static bool if_rx_valid = false;
 
-bool can_init(const char* interface_name) {
-    if (!data_mutex) data_mutex = SDL_CreateMutex();
+// CPU clock of the receive thread, readable from other threads
+static clockid_t thread_cpu_clock;
+static atomic_bool thread_cpu_set = false;
+
+static bool thread_cpu_us(uint64_t* out) {
+    if (!atomic_load_explicit(&thread_cpu_set, memory_order_acquire)) return false;
+    struct timespec ts;
+    if (clock_gettime(thread_cpu_clock, &ts) != 0) return false;
+    *out = (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+    return true;
+}
+
+// Frames seen by the interface, from the netdev statistics
+static bool read_if_rx_packets(uint64_t* out) {
+    char path[96];
+    snprintf(path, sizeof(path), "/sys/class/net/%s/statistics/rx_packets", if_name);
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    unsigned long long v = 0;
+    bool ok = fscanf(f, "%llu", &v) == 1;
+    fclose(f);
+    *out = v;
+    return ok;
+}
 
+static bool if_rx_since_init(uint64_t* out) {
+    uint64_t now;
+    if (!if_rx_valid || !read_if_rx_packets(&now)) return false;
+    *out = now - if_rx_base;
+    return true;
+}
+
+// --- PER-ID INTER-ARRIVAL TIMING ---
+// Written by the CAN thread; relaxed atomics so can_get_id_timing() can read
+// them from another thread without tearing.
+typedef struct {
+    uint32_t can_id;
+    atomic_ullong count;
+    atomic_ullong last_us;
+    atomic_ullong gap_sum_us;
+    atomic_ullong gap_max_us;
+} id_timing_t;
+
+static id_timing_t id_timing[CAN_ID_TIMING_MAX];
+static atomic_int id_timing_count = 0;
+static uint8_t id_timing_slot[CAN_SFF_MASK + 1];   // Standard ID -> slot + 1
+
+static id_timing_t* find_id_timing(uint32_t can_id) {
+    int count = atomic_load_explicit(&id_timing_count, memory_order_relaxed);
+    if (!(can_id & CAN_EFF_FLAG) && can_id <= CAN_SFF_MASK) {
+        uint8_t slot = id_timing_slot[can_id];
+        if (slot) return &id_timing[slot - 1];
+    } else {
+        for (int i = 0; i < count; i++) {
+            if (id_timing[i].can_id == can_id) return &id_timing[i];
+        }
+    }
+    if (count >= CAN_ID_TIMING_MAX) return NULL;
+
+    id_timing_t* t = &id_timing[count];
+    t->can_id = can_id;
+    if (!(can_id & CAN_EFF_FLAG) && can_id <= CAN_SFF_MASK) id_timing_slot[can_id] = (uint8_t)(count + 1);
+    atomic_store_explicit(&id_timing_count, count + 1, memory_order_release);
+    return t;
+}
+
+static void track_id_timing(uint32_t can_id, uint64_t ts_us) {
+    id_timing_t* t = find_id_timing(can_id);
+    if (!t) return;
+
+    uint64_t n = atomic_load_explicit(&t->count, memory_order_relaxed);
+    uint64_t last = atomic_load_explicit(&t->last_us, memory_order_relaxed);
+    if (n > 0 && ts_us > last) {
+        uint64_t gap = ts_us - last;
+        atomic_store_explicit(&t->gap_sum_us,
+            atomic_load_explicit(&t->gap_sum_us, memory_order_relaxed) + gap, memory_order_relaxed);
+        if (gap > atomic_load_explicit(&t->gap_max_us, memory_order_relaxed))
+            atomic_store_explicit(&t->gap_max_us, gap, memory_order_relaxed);
+    }
+    atomic_store_explicit(&t->last_us, ts_us, memory_order_relaxed);
+    atomic_store_explicit(&t->count, n + 1, memory_order_relaxed);
+}
+
+int can_get_id_timing(can_id_timing_t* out, int max) {
+    int count = atomic_load_explicit(&id_timing_count, memory_order_acquire);
+    int n = 0;
+    for (int i = 0; i < count && n < max; i++) {
+        uint64_t frames = atomic_load_explicit(&id_timing[i].count, memory_order_relaxed);
+        out[n].can_id = id_timing[i].can_id;
+        out[n].frames = frames;
+        out[n].mean_gap_us = frames > 1
+            ? atomic_load_explicit(&id_timing[i].gap_sum_us, memory_order_relaxed) / (frames - 1) : 0;
+        out[n].max_gap_us = atomic_load_explicit(&id_timing[i].gap_max_us, memory_order_relaxed);
+        n++;
+    }
+    return n;
+}
+
+// Accept only the IDs we decode, so other bus traffic never leaves the kernel.
+// Exact-match SFF/EFF filters are looked up by ID in the kernel's receive
+// table, so one filter per ID is cheaper than a wide mask.
+static void install_filters(void) {
+    int max = EMU_FRAME_COUNT + extra_id_count + (dbc_loaded ? dbc.msg_count : 0);
+    uint32_t* ids = malloc((size_t)max * sizeof(uint32_t));
+    struct can_filter* filters = malloc((size_t)max * sizeof(struct can_filter));
+    if (!ids || !filters) {
+        free(ids);
+        free(filters);
+        printf("CAN: Out of memory, kernel filter not installed\n");
+        return;
+    }
+
+    int count = emu_decoder_ids(&emu, ids, EMU_FRAME_COUNT);
+    if (dbc_loaded) count += dbc_plan_ids(&dbc, ids + count, dbc.msg_count);
+    for (int i = 0; i < extra_id_count; i++) {
+        uint32_t id = extra_ids[i];
+        ids[count++] = (id > CAN_SFF_MASK) ? ((id & CAN_EFF_MASK) | CAN_EFF_FLAG) : id;
+    }
+
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        bool dup = false;
+        for (int j = 0; j < n; j++) {
+            if (filters[j].can_id == ids[i]) dup = true;
+        }
+        if (dup) continue;
+
+        filters[n].can_id = ids[i];
+        filters[n].can_mask = (ids[i] & CAN_EFF_FLAG)
+            ? (CAN_EFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG)
+            : (CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG);
+        n++;
+    }
+
+    if (n > CAN_RAW_FILTER_MAX) {
+        printf("CAN: %d IDs exceed the kernel filter limit, receiving the whole bus\n", n);
+    } else if (setsockopt(s_socket, SOL_CAN_RAW, CAN_RAW_FILTER, filters, (socklen_t)(n * sizeof(filters[0]))) < 0) {
+        perror("CAN filter");
+    } else {
+        printf("CAN: Kernel filter installed for %d IDs\n", n);
+    }
+    free(ids);
+    free(filters);
+}
+
+bool can_init(const char* interface_name) {
     struct sockaddr_can addr;
     struct ifreq ifr;
 
+    init_decoder();
+
     if ((s_socket = socket(PF_CAN, SOCK_RAW, CAN_RAW)) < 0) {
         perror("CAN socket");
         return false;
     }
 
-    strcpy(ifr.ifr_name, interface_name);
+    snprintf(if_name, sizeof(if_name), "%s", interface_name);
+    strcpy(ifr.ifr_name, if_name);
     ioctl(s_socket, SIOCGIFINDEX, &ifr);
 
+    if (filtering_enabled) install_filters();
+
+    // Report receive queue overflows with every frame
+    int one = 1;
+    setsockopt(s_socket, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one));
+
+    // Kernel receive timestamps. Software stamps are taken when the driver
+    // hands the frame to the stack, before any scheduling delay of our thread.
+    int ts_flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    kernel_ts = setsockopt(s_socket, SOL_SOCKET, SO_TIMESTAMPING, &ts_flags, sizeof(ts_flags)) == 0;
+    if (!kernel_ts) printf("CAN: Kernel timestamps unavailable, using receive time\n");
+
     addr.can_family = AF_CAN;
     addr.can_ifindex = ifr.ifr_ifindex;
 
@@ -61,89 +417,178 @@ bool can_init(const char* interface_name) {
         perror("CAN bind");
         return false;
     }
+    if_rx_valid = read_if_rx_packets(&if_rx_base);
     printf("CAN: Connected to %s\n", interface_name);
     return true;
 }
 
+// Kernel software timestamps are CLOCK_REALTIME; this offset maps them onto
+// the monotonic clock. Sampled once per batch.
+static int64_t realtime_offset_us(void) {
+    struct timespec rt, mt;
+    clock_gettime(CLOCK_REALTIME, &rt);
+    clock_gettime(CLOCK_MONOTONIC, &mt);
+    return ((int64_t)rt.tv_sec - (int64_t)mt.tv_sec) * 1000000 + (rt.tv_nsec - mt.tv_nsec) / 1000;
+}
+
+// Pull the receive timestamp and queue drop counter out of the control data
+static uint64_t read_cmsgs(struct msghdr* mh, int64_t rt_offset, uint64_t fallback_us) {
+    uint64_t ts_us = fallback_us;
+    for (struct cmsghdr* c = CMSG_FIRSTHDR(mh); c; c = CMSG_NXTHDR(mh, c)) {
+        if (c->cmsg_level != SOL_SOCKET) continue;
+        if (c->cmsg_type == SO_RXQ_OVFL) {
+            uint32_t drops;
+            memcpy(&drops, CMSG_DATA(c), sizeof(drops));
+            atomic_store_explicit(&stat_rx_overflow, drops, memory_order_relaxed);
+        } else if (c->cmsg_type == SCM_TIMESTAMPING) {
+            struct scm_timestamping tss;
+            memcpy(&tss, CMSG_DATA(c), sizeof(tss));
+            if (tss.ts[0].tv_sec == 0 && tss.ts[0].tv_nsec == 0) continue;
+            int64_t rt_us = (int64_t)tss.ts[0].tv_sec * 1000000 + tss.ts[0].tv_nsec / 1000;
+            int64_t mono_us = rt_us - rt_offset;
+            // Guard against wall clock steps between the stamp and our offset sample
+            if (mono_us > 0 && (uint64_t)mono_us <= fallback_us) ts_us = (uint64_t)mono_us;
+        }
+    }
+    return ts_us;
+}
+
 int can_thread_entry(void* data) {
     (void)data;
-    struct can_frame frame;
-    printf("CAN: Listener thread started.\n");
+    static struct can_frame frames[CAN_BATCH_MAX];
+    static struct iovec iovs[CAN_BATCH_MAX];
+    static struct mmsghdr msgs[CAN_BATCH_MAX];
+    static char ctrl[CAN_BATCH_MAX][CMSG_SPACE(sizeof(uint32_t)) + CMSG_SPACE(sizeof(struct scm_timestamping))];
+
+    for (int i = 0; i < CAN_BATCH_MAX; i++) {
+        iovs[i].iov_base = &frames[i];
+        iovs[i].iov_len = sizeof(struct can_frame);
+        memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = ctrl[i];
+    }
+
+    atomic_store_explicit(&stat_start_us, mono_time_us(), memory_order_relaxed);
+    if (pthread_getcpuclockid(pthread_self(), &thread_cpu_clock) == 0)
+        atomic_store_explicit(&thread_cpu_set, true, memory_order_release);
+    printf("CAN: Listener thread started (batch %d frames, max wait %d us).\n",
+           batch_frames, batch_wait_us);
 
     while (1) {
-        int nbytes = read(s_socket, &frame, sizeof(struct can_frame));
-        if (nbytes < 0) {
-            perror("CAN read");
+        // The kernel shrinks msg_controllen to what it wrote, so reset it every time
+        for (int i = 0; i < batch_frames; i++) msgs[i].msg_hdr.msg_controllen = sizeof(ctrl[i]);
+
+        // Block for the first frame, then take whatever else is already queued
+        int n = recvmmsg(s_socket, msgs, batch_frames, MSG_WAITFORONE, NULL);
+        int syscalls = 1;
+        if (n < 0) {
+            count_batch(0, syscalls);
+            if (errno == EINTR) continue;
+            perror("CAN recvmmsg");
             SDL_Delay(100);
             continue;
         }
 
-        SDL_LockMutex(data_mutex);
-        switch(frame.can_id) {
-            case 0x600: {
-                uint16_t raw_rpm = (uint16_t)frame.data[0] | ((uint16_t)frame.data[1] << 8);
-                current_rpm = clamp_i((int)raw_rpm, 0, 12000);
+        // Optionally linger for more frames, bounded by batch_wait_us after the first one
+        if (n < batch_frames && batch_wait_us > 0) {
+            uint64_t deadline = mono_time_us() + (uint64_t)batch_wait_us;
+            struct pollfd pfd = { .fd = s_socket, .events = POLLIN };
 
-                int8_t raw_iat = (int8_t)frame.data[3];
-                current_iat = clamp_i((int)raw_iat, -40, 150);
+            while (n < batch_frames) {
+                uint64_t now = mono_time_us();
+                if (now >= deadline) break;
+                uint64_t left = deadline - now;
+                struct timespec ts = { .tv_sec = (time_t)(left / 1000000u),
+                                       .tv_nsec = (long)(left % 1000000u) * 1000 };
+                syscalls++;
+                if (ppoll(&pfd, 1, &ts, NULL) <= 0) break;
 
-                uint16_t raw_map = (uint16_t)frame.data[4] | ((uint16_t)frame.data[5] << 8);
-                float boost = ((float)raw_map / 100.0f) - 1.0f;
-                current_boost = clamp_f(boost, -1.0f, 4.0f);
-                break;
+                syscalls++;
+                int got = recvmmsg(s_socket, msgs + n, batch_frames - n, MSG_DONTWAIT, NULL);
+                if (got <= 0) break;
+                n += got;
             }
-            case 0x602: {
-                uint16_t raw_egt = (uint16_t)frame.data[3] | ((uint16_t)frame.data[4] << 8);
-                current_egt = clamp_i((int)raw_egt, 0, 1200);
+        }
 
-                uint16_t raw_speed = (uint16_t)frame.data[5] | ((uint16_t)frame.data[6] << 8);
-                current_speed = clamp_i((int)raw_speed, 0, 400);
-                break;
-            }
-            case 0x603: {
-                current_clt = clamp_i((int)((int8_t)frame.data[0]), -40, 150);
-                current_oil_t = clamp_i((int)((int8_t)frame.data[1]), -40, 180);
-                
-                // Assuming Oil Press is sent as Bar * 10 or similar from ECU
-                current_oil_press = clamp_f((float)frame.data[2] / 10.0f, 0.0f, 12.0f);
-                break;
-            }
+        uint64_t batch_us = mono_time_us();
+        int64_t rt_offset = kernel_ts ? realtime_offset_us() : 0;
+
+        uint64_t touched = 0;
+        for (int i = 0; i < n; i++) {
+            if (msgs[i].msg_len != sizeof(struct can_frame)) continue;
+            uint64_t ts_us = read_cmsgs(&msgs[i].msg_hdr, rt_offset, batch_us);
+            can_recorder_push(frames[i].can_id, frames[i].can_dlc, frames[i].data, ts_us);
+            uint64_t t = decode_frame(frames[i].can_id, frames[i].can_dlc, frames[i].data, ts_us);
+            if (t && ts_us > work.rx_us) work.rx_us = ts_us;
+            touched |= t;
         }
-        SDL_UnlockMutex(data_mutex);
+
+        // One publish per batch
+        if (touched) publish_snapshot();
+        count_batch(n, syscalls);
     }
     return 0;
 }
 
 #else
 // --- WINDOWS SIMULATION ---
+static void track_id_timing(uint32_t can_id, uint64_t ts_us) {
+    (void)can_id; (void)ts_us;
+}
+
+static bool if_rx_since_init(uint64_t* out) {
+    (void)out;
+    return false;
+}
+
+static bool thread_cpu_us(uint64_t* out) {
+    (void)out;
+    return false;
+}
+
+int can_get_id_timing(can_id_timing_t* out, int max) {
+    (void)out; (void)max;
+    return 0;
+}
+
 bool can_init(const char* interface_name) {
     (void)interface_name;
-    if (!data_mutex) data_mutex = SDL_CreateMutex();
     printf("CAN: Windows detected - SIMULATION MODE.\n");
     return true;
 }
 
 int can_thread_entry(void* data) {
     (void)data;
+    atomic_store_explicit(&stat_start_us, mono_time_us(), memory_order_relaxed);
     printf("CAN: Simulation thread started.\n");
+    const uint64_t sim_channels =
+        (1ull << CAN_CH_RPM) | (1ull << CAN_CH_SPEED) | (1ull << CAN_CH_BOOST) | (1ull << CAN_CH_MAP) |
+        (1ull << CAN_CH_OIL_PRESS) | (1ull << CAN_CH_EGT) | (1ull << CAN_CH_CLT) |
+        (1ull << CAN_CH_OIL_TEMP) | (1ull << CAN_CH_IAT);
+    int rpm = 0;
     while (1) {
-        SDL_LockMutex(data_mutex);
         static int dir = 1;
-        current_rpm += (150 * dir);
-        if (current_rpm > 8500) dir = -1;
-        if (current_rpm < 800) dir = 1;
+        rpm += (150 * dir);
+        if (rpm > 8500) dir = -1;
+        if (rpm < 800) dir = 1;
 
-        current_speed = current_rpm / 100;
-        current_boost = ((float)current_rpm / 8000.0f) * 2.5f - 1.0f;
+        work.values[CAN_CH_RPM] = (float)rpm;
+        work.values[CAN_CH_SPEED] = (float)(rpm / 100);
+        work.values[CAN_CH_BOOST] = ((float)rpm / 8000.0f) * 2.5f - 1.0f;
+        work.values[CAN_CH_MAP] = (work.values[CAN_CH_BOOST] + 1.0f) * 100.0f;
         
         // Smoother Oil Press Simulation: Base 2 bar + RPM link + aggressive jitter
-        current_oil_press = clamp_f(2.0f + ((float)current_rpm / 2500.0f) + ((rand() % 100) / 100.0f), 0.0f, 10.0f); 
+        work.values[CAN_CH_OIL_PRESS] = clamp_f(2.0f + ((float)rpm / 2500.0f) + ((rand() % 100) / 100.0f), 0.0f, 10.0f); 
         
-        current_egt = 300 + (current_rpm / 15);
-        current_clt = 88 + (rand() % 3);
-        current_oil_t = 95 + (rand() % 2);
-        current_iat = 35;
-        SDL_UnlockMutex(data_mutex);
+        work.values[CAN_CH_EGT] = (float)(300 + (rpm / 15));
+        work.values[CAN_CH_CLT] = (float)(88 + (rand() % 3));
+        work.values[CAN_CH_OIL_TEMP] = (float)(95 + (rand() % 2));
+        work.values[CAN_CH_IAT] = 35.0f;
+        work.rx_us = mono_time_us();
+        stamp_channels(sim_channels, work.rx_us);
+        publish_snapshot();
+        count_batch(1, 0);
 
         SDL_Delay(33);
     }
@@ -151,52 +596,78 @@ int can_thread_entry(void* data) {
 }
 #endif
 
-// --- THREAD-SAFE GETTERS ---
-int can_get_rpm(void) { 
-    SDL_LockMutex(data_mutex);
-    int val = current_rpm;
-    SDL_UnlockMutex(data_mutex);
-    return val;
-}
-int can_get_speed(void) { 
-    SDL_LockMutex(data_mutex);
-    int val = current_speed;
-    SDL_UnlockMutex(data_mutex);
-    return val;
-}
-float can_get_boost(void) { 
-    SDL_LockMutex(data_mutex);
-    float val = current_boost;
-    SDL_UnlockMutex(data_mutex);
-    return val;
-}
-float can_get_oil_press(void) { 
-    SDL_LockMutex(data_mutex);
-    float val = current_oil_press;
-    SDL_UnlockMutex(data_mutex);
-    return val;
-}
-int can_get_coolant_temp(void) { 
-    SDL_LockMutex(data_mutex);
-    int val = current_clt;
-    SDL_UnlockMutex(data_mutex);
-    return val;
-}
-int can_get_oil_temp(void) { 
-    SDL_LockMutex(data_mutex);
-    int val = current_oil_t;
-    SDL_UnlockMutex(data_mutex);
-    return val;
+// --- LOCK-FREE READERS ---
+void can_get_snapshot(can_snapshot_t* out) {
+    atomic_fetch_add_explicit(&stat_reads, 1, memory_order_relaxed);
+
+    while (1) {
+        unsigned int s1 = atomic_load_explicit(&snap_seq, memory_order_acquire);
+        if ((s1 & 1u) == 0) {
+            *out = shared_snap;
+            atomic_thread_fence(memory_order_acquire);
+            unsigned int s2 = atomic_load_explicit(&snap_seq, memory_order_relaxed);
+            if (s1 == s2) return;
+        }
+        // Raced a publish in progress, try again
+        atomic_fetch_add_explicit(&stat_retries, 1, memory_order_relaxed);
+    }
 }
-int can_get_egt(void) { 
-    SDL_LockMutex(data_mutex);
-    int val = current_egt;
-    SDL_UnlockMutex(data_mutex);
-    return val;
+
+void can_get_stats(can_stats_t* out) {
+    out->snapshot_reads = atomic_load_explicit(&stat_reads, memory_order_relaxed);
+    out->snapshot_retries = atomic_load_explicit(&stat_retries, memory_order_relaxed);
+    out->frames = atomic_load_explicit(&stat_frames, memory_order_relaxed);
+    out->batches = atomic_load_explicit(&stat_batches, memory_order_relaxed);
+    out->syscalls = atomic_load_explicit(&stat_syscalls, memory_order_relaxed);
+    out->max_batch = atomic_load_explicit(&stat_max_batch, memory_order_relaxed);
+    out->rx_overflow = atomic_load_explicit(&stat_rx_overflow, memory_order_relaxed);
+    out->bad_dlc = atomic_load_explicit(&stat_bad_dlc, memory_order_relaxed);
+
+    uint64_t if_rx = 0;
+    out->if_rx_valid = if_rx_since_init(&if_rx);
+    out->if_rx_frames = if_rx;
+    // Whatever the interface saw but never reached us (and was not a queue overflow)
+    uint64_t accounted = out->frames + out->rx_overflow;
+    out->kernel_filtered = (out->if_rx_valid && if_rx > accounted) ? if_rx - accounted : 0;
+
+    uint64_t start = atomic_load_explicit(&stat_start_us, memory_order_relaxed);
+    out->uptime_us = start ? mono_time_us() - start : 0;
+    out->thread_cpu_us = 0;
+    out->thread_cpu_valid = thread_cpu_us(&out->thread_cpu_us);
 }
-int can_get_iat(void) { 
-    SDL_LockMutex(data_mutex);
-    int val = current_iat;
-    SDL_UnlockMutex(data_mutex);
-    return val;
+
+void can_print_stats(void) {
+    can_stats_t st;
+    can_get_stats(&st);
+
+    double secs = (double)st.uptime_us / 1e6;
+    if (secs <= 0.0) secs = 1e-6;
+
+    printf("CAN: %llu frames in %llu batches (avg %.2f, max %u frames/batch)\n",
+           (unsigned long long)st.frames, (unsigned long long)st.batches,
+           st.batches ? (double)st.frames / (double)st.batches : 0.0, st.max_batch);
+    printf("CAN: %llu syscalls in %.1f s (%.0f/s, %.0f frames/s)\n",
+           (unsigned long long)st.syscalls, secs,
+           (double)st.syscalls / secs, (double)st.frames / secs);
+    if (st.if_rx_valid) {
+        printf("CAN: interface rx %llu, delivered %llu, dropped by kernel filter %llu (%.1f%%), queue overflows %u\n",
+               (unsigned long long)st.if_rx_frames, (unsigned long long)st.frames,
+               (unsigned long long)st.kernel_filtered,
+               st.if_rx_frames ? 100.0 * (double)st.kernel_filtered / (double)st.if_rx_frames : 0.0,
+               st.rx_overflow);
+    }
+    if (st.thread_cpu_valid) {
+        printf("CAN: receive thread CPU %.3f s (%.1f%% of one core)\n",
+               (double)st.thread_cpu_us / 1e6, 100.0 * (double)st.thread_cpu_us / 1e6 / secs);
+    }
+    if (st.bad_dlc) printf("CAN: %u frames rejected for short DLC\n", st.bad_dlc);
+
+    can_id_timing_t timing[CAN_ID_TIMING_MAX];
+    int n = can_get_id_timing(timing, CAN_ID_TIMING_MAX);
+    for (int i = 0; i < n; i++) {
+        printf("CAN:   ID 0x%03X: %llu frames, mean gap %.2f ms, max gap %.2f ms\n",
+               timing[i].can_id & 0x1FFFFFFFu, (unsigned long long)timing[i].frames,
+               (double)timing[i].mean_gap_us / 1000.0, (double)timing[i].max_gap_us / 1000.0);
+    }
+    printf("CAN: %u snapshot reads, %u retries\n", st.snapshot_reads, st.snapshot_retries);
 }
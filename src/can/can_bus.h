@@ -4,20 +4,163 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Sensor channels held in the shared data store
+typedef enum {
+    // Dashboard readouts
+    CAN_CH_RPM = 0,
+    CAN_CH_SPEED,           // km/h
+    CAN_CH_BOOST,           // bar (relative)
+    CAN_CH_OIL_PRESS,       // bar
+    CAN_CH_CLT,             // C
+    CAN_CH_OIL_TEMP,        // C
+    CAN_CH_EGT,             // C (EGT #1)
+    CAN_CH_IAT,             // C
+
+    // Remaining EMU Black channels (see emu_data_t in EMUcan.h)
+    CAN_CH_MAP,             // kPa
+    CAN_CH_TPS,             // %
+    CAN_CH_INJ_PW,          // ms
+    CAN_CH_AIN1,            // V
+    CAN_CH_AIN2,
+    CAN_CH_AIN3,
+    CAN_CH_AIN4,
+    CAN_CH_AIN5,
+    CAN_CH_AIN6,
+    CAN_CH_BARO,            // kPa
+    CAN_CH_FUEL_PRESS,      // bar
+    CAN_CH_IGN_ANGLE,       // deg
+    CAN_CH_DWELL,           // ms
+    CAN_CH_LAMBDA,          // lambda
+    CAN_CH_LAMBDA_CORR,     // %
+    CAN_CH_EGT2,            // C
+    CAN_CH_GEAR,
+    CAN_CH_ECU_TEMP,        // C
+    CAN_CH_BATT,            // V
+    CAN_CH_CEL,             // Error flags (EMUcan ERRORFLAG bits)
+    CAN_CH_FLAGS1,          // EMUcan FLAGS1 bits
+    CAN_CH_ETHANOL,         // %
+    CAN_CH_DBW_POS,         // %
+    CAN_CH_DBW_TARGET,      // %
+    CAN_CH_TC_DRPM_RAW,
+    CAN_CH_TC_DRPM,
+    CAN_CH_TC_TORQUE_RED,   // %
+    CAN_CH_PIT_TORQUE_RED,  // %
+    CAN_CH_OUTFLAGS1,
+    CAN_CH_OUTFLAGS2,
+    CAN_CH_OUTFLAGS3,
+    CAN_CH_OUTFLAGS4,
+    CAN_CH_BOOST_TARGET,    // kPa
+    CAN_CH_PWM1,            // %
+    CAN_CH_DSG_MODE,
+    CAN_CH_LAMBDA_TARGET,   // lambda
+    CAN_CH_PWM2,            // %
+    CAN_CH_FUEL_USED,       // L
+    CAN_CH_COUNT
+} can_channel_t;
+
+// Channel names (can_channels.c). from_name is case-insensitive, -1 if unknown.
+const char* can_channel_name(can_channel_t ch);
+int can_channel_from_name(const char* name);
+
+// One consistent view of every channel, taken at the same instant
+typedef struct {
+    uint32_t seq;                   // Publication counter, advances on every update
+    float values[CAN_CH_COUNT];     // Indexed by can_channel_t
+    uint64_t stamp_us[CAN_CH_COUNT];// Monotonic receive time (mono_time_us), 0 = never
+    uint64_t rx_us;                 // Receive time of the newest frame in this publish
+} can_snapshot_t;
+
+// Per-channel freshness, modelled on EMUcan_STATUS
+typedef enum {
+    CAN_STATUS_WAITING = 0,   // Nothing received yet (EMUcan_FRESH)
+    CAN_STATUS_FRESH,         // Updated within the stale timeout
+    CAN_STATUS_STALE          // No update within the stale timeout
+} can_status_t;
+
+// Inter-arrival statistics of one received CAN ID
+typedef struct {
+    uint32_t can_id;
+    uint64_t frames;
+    uint64_t mean_gap_us;
+    uint64_t max_gap_us;
+} can_id_timing_t;
+
+#define CAN_ID_TIMING_MAX 64
+
+// Diagnostic counters
+typedef struct {
+    uint32_t snapshot_reads;      // can_get_snapshot() calls
+    uint32_t snapshot_retries;    // Reads that raced the writer and had to spin
+    uint64_t frames;              // Frames received
+    uint64_t batches;             // Non-empty receive batches
+    uint64_t syscalls;            // Receive-path syscalls (recvmmsg + ppoll)
+    uint32_t max_batch;           // Largest batch seen
+    uint64_t uptime_us;           // Time since the CAN thread started
+    bool thread_cpu_valid;        // thread_cpu_us available
+    uint64_t thread_cpu_us;       // CPU time used by the CAN thread
+    bool if_rx_valid;             // Interface counters available
+    uint64_t if_rx_frames;        // Frames seen by the interface since can_init
+    uint64_t kernel_filtered;     // Frames the kernel filter kept out of user space
+    uint32_t rx_overflow;         // Frames dropped because our receive queue was full
+    uint32_t bad_dlc;             // Decoder frames rejected for a short DLC
+} can_stats_t;
+
+// Receive batching limits
+#define CAN_BATCH_MAX     64
+#define CAN_BATCH_DEFAULT 16
+
+// Channels without an update for this long are stale (default 1000 ms)
+void can_set_stale_timeout_ms(int ms);
+
+// Base ID of the EMU Black CAN stream (default 0x600). Call before can_init.
+void can_set_emu_base(uint32_t base);
+
+// Load a .dbc file whose signal names match channel names. Its messages are
+// decoded in addition to (and take precedence over) the EMU table.
+// Call before can_init.
+bool can_load_dbc(const char* path);
+
+// Receive these IDs in addition to the decoded EMU frames (IDs above 0x7FF
+// are treated as extended). Call before can_init.
+bool can_add_filter_id(uint32_t id);
+
+// Kernel ID filtering is on by default; disable to receive the whole bus
+void can_set_filtering(bool enabled);
+
 // Initialize CAN interface
 bool can_init(const char* interface_name);
 
+// Receive up to max_frames per batch. After the first frame of a batch arrives,
+// wait at most max_wait_us for more before decoding (0 = take only what is
+// already queued). Call before starting the thread.
+void can_set_batch(int max_frames, int max_wait_us);
+
+// Push an SDL event of this type (from SDL_RegisterEvents) whenever new data
+// is published, so the render loop can sleep until there is something to
+// show. At most one event is queued at a time; the loop calls can_notify_ack()
+// when it takes the event and before it reads the snapshot.
+void can_set_notify_event(uint32_t sdl_event_type);
+void can_notify_ack(void);
+
+// Replay without an interface: set up the decoder only, then feed frames from
+// a single thread with can_inject_frame() and make them visible with
+// can_inject_publish() (once per batch, like the receive loop).
+bool can_init_replay(void);
+uint64_t can_inject_frame(uint32_t can_id, uint8_t dlc, const uint8_t* data, uint64_t ts_us);
+void can_inject_publish(int frames, uint64_t touched);
+
 // Thread function for background reading
 int can_thread_entry(void* data);
 
-// Getters
-int can_get_rpm(void);
-int can_get_speed(void);
-float can_get_boost(void);
-float can_get_oil_press(void); // Changed to float
-int can_get_coolant_temp(void);
-int can_get_oil_temp(void);
-int can_get_egt(void);
-int can_get_iat(void);
+// Copy the latest published data. Lock-free; never blocks the CAN thread.
+void can_get_snapshot(can_snapshot_t* out);
+
+can_status_t can_channel_status(const can_snapshot_t* snap, can_channel_t ch, uint64_t now_us);
+
+// Copies up to max per-ID timing entries, returns the count
+int can_get_id_timing(can_id_timing_t* out, int max);
+
+void can_get_stats(can_stats_t* out);
+void can_print_stats(void);
 
 #endif // CAN_BUS_H
@@ -0,0 +1,64 @@
+#include "can_bus.h"
+#include <strings.h>
+
+// Channel names, matched case-insensitively against DBC signal names
+static const char* const channel_names[CAN_CH_COUNT] = {
+    [CAN_CH_RPM]            = "RPM",
+    [CAN_CH_SPEED]          = "SPEED",
+    [CAN_CH_BOOST]          = "BOOST",
+    [CAN_CH_OIL_PRESS]      = "OIL_PRESS",
+    [CAN_CH_CLT]            = "CLT",
+    [CAN_CH_OIL_TEMP]       = "OIL_TEMP",
+    [CAN_CH_EGT]            = "EGT",
+    [CAN_CH_IAT]            = "IAT",
+    [CAN_CH_MAP]            = "MAP",
+    [CAN_CH_TPS]            = "TPS",
+    [CAN_CH_INJ_PW]         = "INJ_PW",
+    [CAN_CH_AIN1]           = "AIN1",
+    [CAN_CH_AIN2]           = "AIN2",
+    [CAN_CH_AIN3]           = "AIN3",
+    [CAN_CH_AIN4]           = "AIN4",
+    [CAN_CH_AIN5]           = "AIN5",
+    [CAN_CH_AIN6]           = "AIN6",
+    [CAN_CH_BARO]           = "BARO",
+    [CAN_CH_FUEL_PRESS]     = "FUEL_PRESS",
+    [CAN_CH_IGN_ANGLE]      = "IGN_ANGLE",
+    [CAN_CH_DWELL]          = "DWELL",
+    [CAN_CH_LAMBDA]         = "LAMBDA",
+    [CAN_CH_LAMBDA_CORR]    = "LAMBDA_CORR",
+    [CAN_CH_EGT2]           = "EGT2",
+    [CAN_CH_GEAR]           = "GEAR",
+    [CAN_CH_ECU_TEMP]       = "ECU_TEMP",
+    [CAN_CH_BATT]           = "BATT",
+    [CAN_CH_CEL]            = "CEL",
+    [CAN_CH_FLAGS1]         = "FLAGS1",
+    [CAN_CH_ETHANOL]        = "ETHANOL",
+    [CAN_CH_DBW_POS]        = "DBW_POS",
+    [CAN_CH_DBW_TARGET]     = "DBW_TARGET",
+    [CAN_CH_TC_DRPM_RAW]    = "TC_DRPM_RAW",
+    [CAN_CH_TC_DRPM]        = "TC_DRPM",
+    [CAN_CH_TC_TORQUE_RED]  = "TC_TORQUE_RED",
+    [CAN_CH_PIT_TORQUE_RED] = "PIT_TORQUE_RED",
+    [CAN_CH_OUTFLAGS1]      = "OUTFLAGS1",
+    [CAN_CH_OUTFLAGS2]      = "OUTFLAGS2",
+    [CAN_CH_OUTFLAGS3]      = "OUTFLAGS3",
+    [CAN_CH_OUTFLAGS4]      = "OUTFLAGS4",
+    [CAN_CH_BOOST_TARGET]   = "BOOST_TARGET",
+    [CAN_CH_PWM1]           = "PWM1",
+    [CAN_CH_DSG_MODE]       = "DSG_MODE",
+    [CAN_CH_LAMBDA_TARGET]  = "LAMBDA_TARGET",
+    [CAN_CH_PWM2]           = "PWM2",
+    [CAN_CH_FUEL_USED]      = "FUEL_USED",
+};
+
+const char* can_channel_name(can_channel_t ch) {
+    if ((unsigned)ch >= CAN_CH_COUNT || !channel_names[ch]) return "?";
+    return channel_names[ch];
+}
+
+int can_channel_from_name(const char* name) {
+    for (int i = 0; i < CAN_CH_COUNT; i++) {
+        if (channel_names[i] && strcasecmp(channel_names[i], name) == 0) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,295 @@
+#include "can_history.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdatomic.h>
+
+#define DT_UNIT_US 100u
+#define DT_MAX     0xFFFFu      // Longer gaps are recorded as ~6.5 s
+
+// Quantisation per channel: value = raw * step + bias. Steps are chosen so
+// the decoder's clamp range fits in int16.
+typedef struct {
+    float step;
+    float bias;
+} quant_t;
+
+static const quant_t quant[CAN_CH_COUNT] = {
+    [CAN_CH_RPM]            = { 1.0f,    0.0f },
+    [CAN_CH_SPEED]          = { 0.1f,    0.0f },
+    [CAN_CH_BOOST]          = { 0.001f,  0.0f },
+    [CAN_CH_OIL_PRESS]      = { 0.001f,  0.0f },
+    [CAN_CH_CLT]            = { 0.1f,    0.0f },
+    [CAN_CH_OIL_TEMP]       = { 0.1f,    0.0f },
+    [CAN_CH_EGT]            = { 0.1f,    0.0f },
+    [CAN_CH_IAT]            = { 0.1f,    0.0f },
+    [CAN_CH_MAP]            = { 0.1f,    0.0f },
+    [CAN_CH_TPS]            = { 0.01f,   0.0f },
+    [CAN_CH_INJ_PW]         = { 0.01f,   0.0f },
+    [CAN_CH_AIN1]           = { 0.001f,  0.0f },
+    [CAN_CH_AIN2]           = { 0.001f,  0.0f },
+    [CAN_CH_AIN3]           = { 0.001f,  0.0f },
+    [CAN_CH_AIN4]           = { 0.001f,  0.0f },
+    [CAN_CH_AIN5]           = { 0.001f,  0.0f },
+    [CAN_CH_AIN6]           = { 0.001f,  0.0f },
+    [CAN_CH_BARO]           = { 0.1f,    0.0f },
+    [CAN_CH_FUEL_PRESS]     = { 0.001f,  0.0f },
+    [CAN_CH_IGN_ANGLE]      = { 0.01f,   0.0f },
+    [CAN_CH_DWELL]          = { 0.001f,  0.0f },
+    [CAN_CH_LAMBDA]         = { 0.0001f, 0.0f },
+    [CAN_CH_LAMBDA_CORR]    = { 0.01f,   0.0f },
+    [CAN_CH_EGT2]           = { 0.1f,    0.0f },
+    [CAN_CH_GEAR]           = { 1.0f,    0.0f },
+    [CAN_CH_ECU_TEMP]       = { 0.1f,    0.0f },
+    [CAN_CH_BATT]           = { 0.001f,  0.0f },
+    [CAN_CH_CEL]            = { 1.0f,    32768.0f },
+    [CAN_CH_FLAGS1]         = { 1.0f,    0.0f },
+    [CAN_CH_ETHANOL]        = { 0.01f,   0.0f },
+    [CAN_CH_DBW_POS]        = { 0.01f,   0.0f },
+    [CAN_CH_DBW_TARGET]     = { 0.01f,   0.0f },
+    [CAN_CH_TC_DRPM_RAW]    = { 1.0f,    32768.0f },
+    [CAN_CH_TC_DRPM]        = { 1.0f,    32768.0f },
+    [CAN_CH_TC_TORQUE_RED]  = { 0.01f,   0.0f },
+    [CAN_CH_PIT_TORQUE_RED] = { 0.01f,   0.0f },
+    [CAN_CH_OUTFLAGS1]      = { 1.0f,    0.0f },
+    [CAN_CH_OUTFLAGS2]      = { 1.0f,    0.0f },
+    [CAN_CH_OUTFLAGS3]      = { 1.0f,    0.0f },
+    [CAN_CH_OUTFLAGS4]      = { 1.0f,    0.0f },
+    [CAN_CH_BOOST_TARGET]   = { 0.1f,    0.0f },
+    [CAN_CH_PWM1]           = { 0.01f,   0.0f },
+    [CAN_CH_DSG_MODE]       = { 1.0f,    0.0f },
+    [CAN_CH_LAMBDA_TARGET]  = { 0.0001f, 0.0f },
+    [CAN_CH_PWM2]           = { 0.01f,   0.0f },
+    [CAN_CH_FUEL_USED]      = { 0.01f,   327.68f },
+};
+
+// One ring. The writer-owned fields sit on their own cache line so readers
+// polling head do not share a line with anything else the writer touches.
+typedef struct {
+    // Seqlock over (head, head_us): even = head * 2, odd while updating
+    _Alignas(64) atomic_ullong seq;
+    atomic_ullong head_us;      // Stamp of sample head - 1
+    uint64_t last_us;           // Writer only
+    atomic_uint* entries;       // (uint16 raw << 16) | dt
+    float inv_step;
+    float step;
+    float bias;
+} ring_t;
+
+static ring_t rings[CAN_CH_COUNT];
+static atomic_uint* storage = NULL;
+static uint32_t capacity = 0;   // Samples per ring, any size: the whole budget is used
+
+// Ring slot of sample i. Readers walk backwards from one slot with prev_slot,
+// so the division is paid once per push and once per read.
+static inline uint32_t slot(uint64_t i) {
+    return (uint32_t)(i % capacity);
+}
+
+static inline uint32_t prev_slot(uint32_t s) {
+    return s ? s - 1 : capacity - 1;
+}
+
+bool can_history_init(int seconds, size_t budget_bytes) {
+    can_history_free();
+    if (seconds < 1) seconds = 1;
+
+    uint64_t want = (uint64_t)seconds * CAN_HISTORY_BUS_FPS;
+    size_t per_sample = sizeof(atomic_uint) * CAN_CH_COUNT;
+    uint64_t cap = budget_bytes / per_sample;
+    if (cap > want) cap = want;
+    if (cap < 16) cap = 16;
+
+    storage = calloc((size_t)cap * CAN_CH_COUNT, sizeof(atomic_uint));
+    if (!storage) {
+        printf("CAN: history allocation failed (%llu samples/channel)\n", (unsigned long long)cap);
+        return false;
+    }
+    capacity = (uint32_t)cap;
+
+    for (int ch = 0; ch < CAN_CH_COUNT; ch++) {
+        ring_t* r = &rings[ch];
+        r->entries = storage + (size_t)ch * cap;
+        r->step = quant[ch].step > 0.0f ? quant[ch].step : 1.0f;
+        r->inv_step = 1.0f / r->step;
+        r->bias = quant[ch].bias;
+        r->last_us = 0;
+        atomic_init(&r->seq, 0);
+        atomic_init(&r->head_us, 0);
+    }
+
+    printf("CAN: history %u samples/channel (%.1f s at full bus rate), %zu KiB\n",
+           capacity, (double)capacity / CAN_HISTORY_BUS_FPS, (size_t)capacity * per_sample / 1024);
+    if (cap < want)
+        printf("Warning: history budget too small for %d s at full bus rate, need %zu KiB (--history-kb).\n",
+               seconds, (size_t)(want * per_sample + 1023) / 1024);
+    return true;
+}
+
+void can_history_free(void) {
+    free(storage);
+    storage = NULL;
+    capacity = 0;
+}
+
+uint32_t can_history_capacity(void) {
+    return capacity;
+}
+
+void can_history_push(can_channel_t ch, float value, uint64_t ts_us) {
+    if (!storage) return;
+    ring_t* r = &rings[ch];
+
+    float q = rintf((value - r->bias) * r->inv_step);
+    if (q > 32767.0f) q = 32767.0f;
+    if (q < -32768.0f) q = -32768.0f;
+
+    // last_us advances by the stored delta, so the truncation carries into
+    // the next one instead of adding up along the ring
+    uint64_t dt = 0;
+    if (!r->last_us || ts_us <= r->last_us) {
+        r->last_us = ts_us;
+    } else {
+        dt = (ts_us - r->last_us) / DT_UNIT_US;
+        if (dt > DT_MAX) {
+            dt = DT_MAX;
+            r->last_us = ts_us;
+        } else {
+            r->last_us += dt * DT_UNIT_US;
+        }
+    }
+
+    uint32_t entry = ((uint32_t)(uint16_t)(int16_t)q << 16) | (uint32_t)dt;
+
+    // Single writer, so plain loads of seq are fine
+    uint64_t seq = atomic_load_explicit(&r->seq, memory_order_relaxed);
+    uint64_t head = seq >> 1;
+    atomic_store_explicit(&r->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&r->entries[slot(head)], entry, memory_order_relaxed);
+    atomic_store_explicit(&r->head_us, ts_us, memory_order_relaxed);
+    atomic_store_explicit(&r->seq, seq + 2, memory_order_release);
+}
+
+// Consistent (head, head_us) pair
+static uint64_t load_head(const ring_t* r, uint64_t* head_us) {
+    while (1) {
+        uint64_t s1 = atomic_load_explicit(&r->seq, memory_order_acquire);
+        if ((s1 & 1u) == 0) {
+            *head_us = atomic_load_explicit(&r->head_us, memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&r->seq, memory_order_relaxed) == s1) return s1 >> 1;
+        }
+    }
+}
+
+static float decode_value(const ring_t* r, uint32_t entry) {
+    return (float)(int16_t)(uint16_t)(entry >> 16) * r->step + r->bias;
+}
+
+// Copy samples [start, min(start + max, head)) into out. Times are rebuilt
+// walking back from the head. Returns the count; *start is advanced past any
+// samples overwritten during the copy and *lost counts them.
+static int read_range(const ring_t* r, uint64_t* start, can_history_sample_t* out,
+                      int max, uint64_t* lost) {
+    uint64_t head_us;
+    uint64_t head = load_head(r, &head_us);
+
+    uint64_t first = *start;
+    if (first > head) first = head;
+    if (head - first > capacity) {
+        *lost += head - capacity - first;
+        first = head - capacity;
+    }
+    uint64_t end = head - first > (uint64_t)max ? first + (uint64_t)max : head;
+
+    uint64_t t = head_us;
+    uint32_t si = slot(head);
+    for (uint64_t i = head; i-- > first; ) {
+        si = prev_slot(si);
+        uint32_t e = atomic_load_explicit(&r->entries[si], memory_order_relaxed);
+        if (i < end) {
+            out[i - first].value = decode_value(r, e);
+            out[i - first].stamp_us = t;
+        }
+        uint64_t dt = (uint64_t)(e & 0xFFFFu) * DT_UNIT_US;
+        t = t > dt ? t - dt : 0;
+    }
+
+    // Anything the writer lapped while we copied is garbage
+    atomic_thread_fence(memory_order_acquire);
+    uint64_t dummy;
+    uint64_t head2 = load_head(r, &dummy);
+    int n = (int)(end - first);
+    if (head2 > capacity && head2 - capacity > first) {
+        uint64_t bad = head2 - capacity - first;
+        if (bad > (uint64_t)n) bad = (uint64_t)n;
+        memmove(out, out + bad, (size_t)(n - (int)bad) * sizeof(*out));
+        n -= (int)bad;
+        *lost += bad;
+        first += bad;
+    }
+    *start = first + (uint64_t)n;
+    return n;
+}
+
+int can_history_read(can_channel_t ch, can_history_cursor_t* cur,
+                     can_history_sample_t* out, int max) {
+    if (!storage || max <= 0) return 0;
+    return read_range(&rings[ch], &cur->next, out, max, &cur->lost);
+}
+
+int can_history_latest(can_channel_t ch, can_history_sample_t* out, int max) {
+    if (!storage || max <= 0) return 0;
+    const ring_t* r = &rings[ch];
+    uint64_t head_us;
+    uint64_t head = load_head(r, &head_us);
+    uint64_t start = head > (uint64_t)max ? head - (uint64_t)max : 0;
+    uint64_t lost = 0;
+    return read_range(r, &start, out, max, &lost);
+}
+
+bool can_history_range(can_channel_t ch, uint64_t since_us, float* min, float* max) {
+    if (!storage) return false;
+    const ring_t* r = &rings[ch];
+
+    bool any;
+    float lo, hi;
+    uint64_t oldest, head2;
+    do {
+        uint64_t head_us;
+        uint64_t head = load_head(r, &head_us);
+        uint64_t first = head > capacity ? head - capacity : 0;
+
+        // Walk back until the stamps drop below since_us; no copy needed
+        any = false;
+        lo = hi = 0.0f;
+        oldest = head;
+        uint64_t t = head_us;
+        uint32_t si = slot(head);
+        for (uint64_t i = head; i-- > first && t >= since_us; ) {
+            si = prev_slot(si);
+            uint32_t e = atomic_load_explicit(&r->entries[si], memory_order_relaxed);
+            float v = decode_value(r, e);
+            if (!any || v < lo) lo = v;
+            if (!any || v > hi) hi = v;
+            any = true;
+            oldest = i;
+            uint64_t dt = (uint64_t)(e & 0xFFFFu) * DT_UNIT_US;
+            if (t < dt) break;
+            t -= dt;
+        }
+
+        // Start over if the writer lapped the oldest sample we used
+        atomic_thread_fence(memory_order_acquire);
+        uint64_t dummy;
+        head2 = load_head(r, &dummy);
+    } while (any && head2 > capacity && head2 - capacity > oldest);
+
+    if (any) {
+        *min = lo;
+        *max = hi;
+    }
+    return any;
+}
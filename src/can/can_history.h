@@ -0,0 +1,59 @@
+#ifndef CAN_HISTORY_H
+#define CAN_HISTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "can_bus.h"
+
+// Per-channel history rings, written by the CAN thread for every decoded
+// update and read by the UI / loggers without locks. The writer never waits:
+// it overwrites the oldest samples, and a reader that falls more than a ring
+// behind is told how many it lost.
+//
+// A sample is 4 bytes: the value quantised to int16 (fixed per-channel step)
+// and the time since the previous sample in 100 us units. Absolute times are
+// rebuilt backwards from the newest sample's stamp.
+
+#define CAN_HISTORY_DEFAULT_SECONDS   10
+#define CAN_HISTORY_DEFAULT_BUDGET_KB 8192    // 10 s of every channel at CAN_HISTORY_BUS_FPS
+
+// Worst case update rate of one channel: every frame on a 500 kbit/s bus
+// (8 byte standard frames, ~111 bits each)
+#define CAN_HISTORY_BUS_FPS 4500
+
+typedef struct {
+    float value;
+    uint64_t stamp_us;      // Monotonic (mono_time_us)
+} can_history_sample_t;
+
+// Per-reader position in one channel's ring. Zero-initialise to start from
+// the oldest sample still held.
+typedef struct {
+    uint64_t next;          // Index of the next sample to return
+    uint64_t lost;          // Samples overwritten before this reader got them
+} can_history_cursor_t;
+
+// Size every ring for `seconds` at CAN_HISTORY_BUS_FPS, shrunk until all
+// channels fit in budget_bytes (with a warning). Call before the CAN thread
+// starts; without it pushes are dropped.
+bool can_history_init(int seconds, size_t budget_bytes);
+void can_history_free(void);
+
+// Samples per channel (0 if not initialised)
+uint32_t can_history_capacity(void);
+
+// CAN thread only
+void can_history_push(can_channel_t ch, float value, uint64_t ts_us);
+
+// Samples published since the cursor, oldest first. Returns the count written.
+int can_history_read(can_channel_t ch, can_history_cursor_t* cur,
+                     can_history_sample_t* out, int max);
+
+// The newest `max` samples (or fewer), oldest first
+int can_history_latest(can_channel_t ch, can_history_sample_t* out, int max);
+
+// Min / max over the samples received at or after since_us. False if none.
+bool can_history_range(can_channel_t ch, uint64_t since_us, float* min, float* max);
+
+#endif // CAN_HISTORY_H
@@ -0,0 +1,534 @@
+#include "can_recorder.h"
+#include <SDL.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <errno.h>
+#include "../util/mono_time.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#define STAGING_BLOCKS 16           // 64 KiB per write
+
+// SocketCAN ID flags (linux/can.h), spelled out for the portable exporter
+#define ID_EFF_FLAG  0x80000000u
+#define ID_RTR_FLAG  0x40000000u
+#define ID_ERR_FLAG  0x20000000u
+#define ID_EFF_MASK  0x1FFFFFFFu
+#define ID_SFF_MASK  0x000007FFu
+#define WRITER_POLL_MS 10
+
+// --- RING (CAN thread -> writer thread) ---
+static can_log_record_t* ring = NULL;
+static uint32_t ring_mask = 0;
+static _Alignas(64) atomic_ullong ring_head = 0;    // Written by the CAN thread
+static _Alignas(64) atomic_ullong ring_tail = 0;    // Written by the writer thread
+
+static atomic_ullong stat_frames = 0;
+static atomic_ullong stat_dropped = 0;
+static atomic_ullong stat_bytes = 0;
+static atomic_uint stat_high_water = 0;
+static atomic_ullong stat_max_write_us = 0;
+static atomic_ullong stat_syncs = 0;
+
+// --- WRITER STATE ---
+static uint8_t* staging = NULL;     // STAGING_BLOCKS blocks, 4 KiB aligned
+static int staging_block = 0;       // Block being filled
+static int staging_count = 0;       // Records in that block
+static uint64_t block_seq = 1;
+static uint64_t sync_us = (uint64_t)CAN_RECORDER_DEFAULT_SYNC_MS * 1000;
+
+static SDL_Thread* writer = NULL;
+static atomic_bool stop_requested = false;
+static bool active = false;
+static char log_path[512];
+
+// --- ROTATION ---
+static char log_dir[256];
+static char log_ifname[16];
+static uint64_t file_bytes = 0;         // Written to the current file
+static uint64_t file_limit = 0;         // Start a new file past this, 0 = never
+static uint64_t dir_limit = 0;          // Delete the oldest logs past this, 0 = keep all
+
+// --- FILE ACCESS ---
+#ifdef __linux__
+static int log_fd = -1;
+
+// Fails with errno EEXIST if the file is already there
+static bool file_open(const char* path) {
+    log_fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    return log_fd >= 0;
+}
+
+static bool file_write(const void* buf, size_t len) {
+    const uint8_t* p = buf;
+    while (len) {
+        ssize_t n = write(log_fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("REC: write");
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static void file_sync(void) {
+    if (fdatasync(log_fd) != 0) perror("REC: fdatasync");
+}
+
+static void file_close(void) {
+    if (log_fd >= 0) close(log_fd);
+    log_fd = -1;
+}
+
+static void make_dir(const char* dir) {
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) perror("REC: mkdir");
+}
+
+static bool is_log_name(const char* name) {
+    size_t len = strlen(name), ext = strlen(CAN_LOG_EXT);
+    return strncmp(name, "can-", 4) == 0 && len > ext && strcmp(name + len - ext, CAN_LOG_EXT) == 0;
+}
+
+// Delete the oldest logs in the directory until they all fit dir_limit.
+// The current file is never deleted.
+static void prune_logs(void) {
+    if (!dir_limit) return;
+    for (int pass = 0; pass < 1000; pass++) {
+        DIR* d = opendir(log_dir);
+        if (!d) {
+            perror("REC: opendir");
+            return;
+        }
+        uint64_t total = 0;
+        time_t oldest_time = 0;
+        char oldest[512] = "";
+        struct dirent* e;
+        while ((e = readdir(d)) != NULL) {
+            if (!is_log_name(e->d_name)) continue;
+            char path[512];
+            struct stat st;
+            snprintf(path, sizeof(path), "%s/%s", log_dir, e->d_name);
+            if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) continue;
+            total += (uint64_t)st.st_size;
+            if (strcmp(path, log_path) == 0) continue;
+            if (!oldest[0] || st.st_mtime < oldest_time) {
+                oldest_time = st.st_mtime;
+                snprintf(oldest, sizeof(oldest), "%s", path);
+            }
+        }
+        closedir(d);
+
+        if (total <= dir_limit || !oldest[0]) return;
+        if (unlink(oldest) != 0) {
+            perror("REC: unlink");
+            return;
+        }
+        printf("REC: deleted %s (recordings over %llu MiB)\n", oldest, (unsigned long long)(dir_limit >> 20));
+    }
+}
+
+static int64_t realtime_offset_us(void) {
+    struct timespec rt, mt;
+    clock_gettime(CLOCK_REALTIME, &rt);
+    clock_gettime(CLOCK_MONOTONIC, &mt);
+    return ((int64_t)rt.tv_sec - (int64_t)mt.tv_sec) * 1000000 + (rt.tv_nsec - mt.tv_nsec) / 1000;
+}
+
+#else
+// --- WINDOWS SIMULATION ---
+static FILE* log_file = NULL;
+
+static bool file_open(const char* path) {
+    log_file = fopen(path, "wbx");
+    if (!log_file) return false;
+    setvbuf(log_file, NULL, _IONBF, 0);
+    return true;
+}
+
+static bool file_write(const void* buf, size_t len) {
+    if (fwrite(buf, 1, len, log_file) != len) {
+        perror("REC: write");
+        return false;
+    }
+    return true;
+}
+
+static void file_sync(void) {
+    fflush(log_file);
+}
+
+static void file_close(void) {
+    if (log_file) fclose(log_file);
+    log_file = NULL;
+}
+
+static void make_dir(const char* dir) {
+    (void)dir;  // Must already exist
+}
+
+static void prune_logs(void) {
+    // Old logs are not deleted here
+}
+
+static int64_t realtime_offset_us(void) {
+    return (int64_t)time(NULL) * 1000000 - (int64_t)mono_time_us();
+}
+#endif
+
+static void note_write_time(uint64_t t0) {
+    uint64_t dt = mono_time_us() - t0;
+    if (dt > atomic_load_explicit(&stat_max_write_us, memory_order_relaxed))
+        atomic_store_explicit(&stat_max_write_us, dt, memory_order_relaxed);
+}
+
+// Stamp the header of the block being filled and move to the next one
+static void close_block(void) {
+    can_log_block_t hdr = { CAN_LOG_BLOCK_MAGIC, (uint16_t)staging_count, 0, block_seq++ };
+    memcpy(staging + (size_t)staging_block * CAN_LOG_BLOCK_SIZE, &hdr, sizeof(hdr));
+    staging_block++;
+    staging_count = 0;
+}
+
+// Write the closed blocks out and start over at the top of the buffer
+static bool write_staging(void) {
+    if (staging_block == 0) return true;
+    size_t len = (size_t)staging_block * CAN_LOG_BLOCK_SIZE;
+    uint64_t t0 = mono_time_us();
+    bool ok = file_write(staging, len);
+    note_write_time(t0);
+    if (ok) atomic_fetch_add_explicit(&stat_bytes, len, memory_order_relaxed);
+    file_bytes += len;
+    memset(staging, 0, len);
+    staging_block = 0;
+    return ok;
+}
+
+static bool stage_record(const can_log_record_t* rec) {
+    uint8_t* block = staging + (size_t)staging_block * CAN_LOG_BLOCK_SIZE;
+    memcpy(block + sizeof(can_log_block_t) + (size_t)staging_count * sizeof(*rec), rec, sizeof(*rec));
+    if (++staging_count < CAN_LOG_BLOCK_RECORDS) return true;
+
+    close_block();
+    return staging_block < STAGING_BLOCKS || write_staging();
+}
+
+static bool drain_ring(void) {
+    uint64_t head = atomic_load_explicit(&ring_head, memory_order_acquire);
+    uint64_t tail = atomic_load_explicit(&ring_tail, memory_order_relaxed);
+    bool ok = true;
+    while (ok && tail != head) {
+        ok = stage_record(&ring[tail & ring_mask]);
+        tail++;
+        // Hand slots back in chunks so the CAN thread sees room early
+        if ((tail & 255) == 0) atomic_store_explicit(&ring_tail, tail, memory_order_release);
+    }
+    atomic_store_explicit(&ring_tail, tail, memory_order_release);
+    return ok;
+}
+
+// Push the partly filled block out too and force it to the medium
+static bool sync_now(void) {
+    if (staging_count > 0) close_block();
+    bool ok = write_staging();
+    uint64_t t0 = mono_time_us();
+    file_sync();
+    note_write_time(t0);
+    atomic_fetch_add_explicit(&stat_syncs, 1, memory_order_relaxed);
+    return ok;
+}
+
+// Create <dir>/can-YYYYmmdd-HHMMSS.mr2log (_1, _2, ... if a log from the same
+// second exists) and stage its header block, written with the first data so
+// every write stays block aligned
+static bool open_log(void) {
+    time_t now = time(NULL);
+    struct tm tm_now;
+#ifdef __linux__
+    localtime_r(&now, &tm_now);
+#else
+    tm_now = *localtime(&now);
+#endif
+    char stamp[32];
+    strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm_now);
+
+    bool opened = false;
+    for (int n = 0; n < 100 && !opened; n++) {
+        if (n == 0) snprintf(log_path, sizeof(log_path), "%s/can-%s" CAN_LOG_EXT, log_dir, stamp);
+        else snprintf(log_path, sizeof(log_path), "%s/can-%s_%d" CAN_LOG_EXT, log_dir, stamp, n);
+        opened = file_open(log_path);
+        if (!opened && errno != EEXIST) break;
+    }
+    if (!opened) {
+        perror("REC: open");
+        return false;
+    }
+
+    can_log_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, CAN_LOG_MAGIC, sizeof(hdr.magic));
+    hdr.version = CAN_LOG_VERSION;
+    hdr.block_size = CAN_LOG_BLOCK_SIZE;
+    // Sampled once: exported wall times ignore later clock steps (NTP/GPS sync)
+    hdr.realtime_offset_us = realtime_offset_us();
+    hdr.start_us = mono_time_us();
+    snprintf(hdr.ifname, sizeof(hdr.ifname), "%s", log_ifname);
+    memset(staging, 0, CAN_LOG_BLOCK_SIZE);
+    memcpy(staging, &hdr, sizeof(hdr));
+    staging_block = 1;
+    staging_count = 0;
+    block_seq = 1;
+    file_bytes = 0;
+    return true;
+}
+
+// After a sync, with nothing staged: continue in a new file once this one is full
+static bool rotate_if_full(void) {
+    if (!file_limit || file_bytes < file_limit) return true;
+    file_close();
+    if (!open_log()) return false;
+    printf("REC: continuing in %s\n", log_path);
+    prune_logs();
+    return true;
+}
+
+static int writer_thread_entry(void* data) {
+    (void)data;
+    uint64_t last_sync = mono_time_us();
+    bool ok = true;
+
+    while (ok) {
+        bool stopping = atomic_load_explicit(&stop_requested, memory_order_acquire);
+        ok = drain_ring();
+
+        uint64_t now = mono_time_us();
+        if (ok && (stopping || now - last_sync >= sync_us)) {
+            ok = sync_now();
+            last_sync = now;
+            if (ok && !stopping) ok = rotate_if_full();
+        }
+        if (stopping) break;
+        SDL_Delay(WRITER_POLL_MS);
+    }
+    if (!ok) printf("REC: write failed, recording stopped (%s).\n", log_path);
+    file_close();
+    return 0;
+}
+
+static void release_buffers(void) {
+    free(ring);
+    free(staging);
+    ring = NULL;
+    staging = NULL;
+}
+
+bool can_recorder_start(const char* dir, const char* ifname, int ring_kb, int sync_ms, int max_mb) {
+    if (active) return true;
+
+    // Ring size: largest power of two of records within ring_kb
+    uint64_t want = (uint64_t)(ring_kb > 0 ? ring_kb : 1) * 1024 / sizeof(can_log_record_t);
+    uint32_t cap = 1024;
+    while ((uint64_t)cap * 2 <= want && cap < (1u << 24)) cap <<= 1;
+
+    ring = calloc(cap, sizeof(can_log_record_t));
+    staging = aligned_alloc(CAN_LOG_BLOCK_SIZE, (size_t)STAGING_BLOCKS * CAN_LOG_BLOCK_SIZE);
+    if (!ring || !staging) {
+        printf("REC: out of memory\n");
+        release_buffers();
+        return false;
+    }
+    memset(staging, 0, (size_t)STAGING_BLOCKS * CAN_LOG_BLOCK_SIZE);
+    ring_mask = cap - 1;
+    if (sync_ms < 1) sync_ms = 1;
+    sync_us = (uint64_t)sync_ms * 1000;
+
+    // Files of CAN_RECORDER_FILE_MB, at least two of them under the cap
+    dir_limit = max_mb > 0 ? (uint64_t)max_mb << 20 : 0;
+    file_limit = (uint64_t)CAN_RECORDER_FILE_MB << 20;
+    if (dir_limit && file_limit > dir_limit / 2) file_limit = dir_limit / 2;
+
+    snprintf(log_dir, sizeof(log_dir), "%s", dir);
+    snprintf(log_ifname, sizeof(log_ifname), "%s", ifname);
+    make_dir(dir);
+    if (!open_log()) {
+        release_buffers();
+        return false;
+    }
+    prune_logs();
+
+    atomic_store(&stop_requested, false);
+    writer = SDL_CreateThread(writer_thread_entry, "CANRecorder", NULL);
+    if (!writer) {
+        printf("REC: thread start failed: %s\n", SDL_GetError());
+        file_close();
+        release_buffers();
+        return false;
+    }
+    active = true;
+    printf("REC: recording to %s (ring %u frames / %u KiB, sync every %d ms)\n",
+           log_path, cap, (unsigned)((size_t)cap * sizeof(can_log_record_t) / 1024), sync_ms);
+    if (dir_limit)
+        printf("REC: new file every %llu MiB, oldest logs deleted past %d MiB\n",
+               (unsigned long long)(file_limit >> 20), max_mb);
+    return true;
+}
+
+void can_recorder_stop(void) {
+    if (!active) return;
+    atomic_store_explicit(&stop_requested, true, memory_order_release);
+    SDL_WaitThread(writer, NULL);
+    writer = NULL;
+    active = false;
+    // The ring stays allocated: the CAN thread may still be pushing into it
+}
+
+void can_recorder_push(uint32_t can_id, uint8_t dlc, const uint8_t* data, uint64_t stamp_us) {
+    if (!ring) return;
+    uint64_t head = atomic_load_explicit(&ring_head, memory_order_relaxed);
+    uint64_t tail = atomic_load_explicit(&ring_tail, memory_order_acquire);
+    uint64_t used = head - tail;
+
+    atomic_fetch_add_explicit(&stat_frames, 1, memory_order_relaxed);
+    if (used > ring_mask) {
+        atomic_fetch_add_explicit(&stat_dropped, 1, memory_order_relaxed);
+        return;
+    }
+    if (used + 1 > atomic_load_explicit(&stat_high_water, memory_order_relaxed))
+        atomic_store_explicit(&stat_high_water, (unsigned int)(used + 1), memory_order_relaxed);
+
+    can_log_record_t* rec = &ring[head & ring_mask];
+    rec->stamp_us = stamp_us;
+    rec->can_id = can_id;
+    rec->dlc = dlc > 8 ? 8 : dlc;
+    rec->flags = 0;
+    rec->reserved[0] = rec->reserved[1] = 0;
+    memcpy(rec->data, data, 8);
+    atomic_store_explicit(&ring_head, head + 1, memory_order_release);
+}
+
+void can_recorder_get_stats(can_recorder_stats_t* out) {
+    out->frames = atomic_load_explicit(&stat_frames, memory_order_relaxed);
+    out->dropped = atomic_load_explicit(&stat_dropped, memory_order_relaxed);
+    out->bytes_written = atomic_load_explicit(&stat_bytes, memory_order_relaxed);
+    out->ring_capacity = ring ? ring_mask + 1 : 0;
+    out->ring_high_water = atomic_load_explicit(&stat_high_water, memory_order_relaxed);
+    out->max_write_us = atomic_load_explicit(&stat_max_write_us, memory_order_relaxed);
+    out->syncs = atomic_load_explicit(&stat_syncs, memory_order_relaxed);
+    out->active = active;
+}
+
+void can_recorder_print_stats(void) {
+    can_recorder_stats_t st;
+    can_recorder_get_stats(&st);
+    if (!st.ring_capacity) return;
+    printf("REC: %llu frames, %llu dropped, %.1f KiB written to %s\n",
+           (unsigned long long)st.frames, (unsigned long long)st.dropped,
+           (double)st.bytes_written / 1024.0, log_path);
+    printf("REC: ring high water %u / %u frames, slowest write/sync %.2f ms, %llu syncs\n",
+           st.ring_high_water, st.ring_capacity, (double)st.max_write_us / 1000.0,
+           (unsigned long long)st.syncs);
+}
+
+// --- LOG READER ---
+bool can_log_open(can_log_reader_t* rd, const char* path) {
+    memset(rd, 0, sizeof(*rd));
+    rd->f = fopen(path, "rb");
+    if (!rd->f) {
+        perror("REC: open log");
+        return false;
+    }
+    if (fread(rd->block, 1, CAN_LOG_BLOCK_SIZE, rd->f) != CAN_LOG_BLOCK_SIZE) {
+        printf("REC: %s: truncated header\n", path);
+        can_log_close(rd);
+        return false;
+    }
+    memcpy(&rd->header, rd->block, sizeof(rd->header));
+    if (memcmp(rd->header.magic, CAN_LOG_MAGIC, sizeof(rd->header.magic)) != 0 ||
+        rd->header.version != CAN_LOG_VERSION || rd->header.block_size != CAN_LOG_BLOCK_SIZE) {
+        printf("REC: %s: not a recorder log (or unsupported version)\n", path);
+        can_log_close(rd);
+        return false;
+    }
+    rd->header.ifname[sizeof(rd->header.ifname) - 1] = '\0';
+    rd->next_seq = 1;
+    return true;
+}
+
+bool can_log_next(can_log_reader_t* rd, can_log_record_t* out) {
+    while (rd->pos >= rd->count) {
+        size_t got = fread(rd->block, 1, CAN_LOG_BLOCK_SIZE, rd->f);
+        if (got == 0) return false;
+        if (got != CAN_LOG_BLOCK_SIZE) {
+            rd->torn_blocks++;  // Cut off mid-write
+            return false;
+        }
+        can_log_block_t hdr;
+        memcpy(&hdr, rd->block, sizeof(hdr));
+        rd->pos = 0;
+        rd->count = 0;
+        if (hdr.magic != CAN_LOG_BLOCK_MAGIC || hdr.count > CAN_LOG_BLOCK_RECORDS) {
+            rd->torn_blocks++;
+            continue;
+        }
+        // Blocks are numbered from 1 in write order. A jump forward lost some;
+        // going back means stale data follows, not this recording.
+        if (hdr.seq < rd->next_seq) {
+            rd->seq_regressed = true;
+            return false;
+        }
+        rd->seq_gaps += hdr.seq - rd->next_seq;
+        rd->count = hdr.count;
+        rd->next_seq = hdr.seq + 1;
+    }
+    memcpy(out, rd->block + sizeof(can_log_block_t) + (size_t)rd->pos * sizeof(*out), sizeof(*out));
+    rd->pos++;
+    return true;
+}
+
+void can_log_close(can_log_reader_t* rd) {
+    if (rd->f) fclose(rd->f);
+    rd->f = NULL;
+}
+
+bool can_log_export_candump(const char* path, FILE* out) {
+    static can_log_reader_t rd;
+    if (!can_log_open(&rd, path)) return false;
+
+    const char* ifname = rd.header.ifname[0] ? rd.header.ifname : "can0";
+    can_log_record_t rec;
+    uint64_t n = 0;
+    while (can_log_next(&rd, &rec)) {
+        int64_t wall_us = (int64_t)rec.stamp_us + rd.header.realtime_offset_us;
+        if (wall_us < 0) wall_us = 0;
+        fprintf(out, "(%010lld.%06lld) %s ", (long long)(wall_us / 1000000), (long long)(wall_us % 1000000), ifname);
+
+        // Error frames keep CAN_ERR_FLAG in the 8-digit ID, as candump
+        // prints them and the replay parser expects
+        if (rec.can_id & ID_ERR_FLAG) fprintf(out, "%08X#", rec.can_id & (ID_ERR_FLAG | ID_EFF_MASK));
+        else if (rec.can_id & ID_EFF_FLAG) fprintf(out, "%08X#", rec.can_id & ID_EFF_MASK);
+        else fprintf(out, "%03X#", rec.can_id & ID_SFF_MASK);
+        if (rec.can_id & ID_RTR_FLAG) {
+            fputc('R', out);
+        } else {
+            for (int i = 0; i < rec.dlc && i < 8; i++) fprintf(out, "%02X", rec.data[i]);
+        }
+        fputc('\n', out);
+        n++;
+    }
+    if (rd.torn_blocks) fprintf(stderr, "REC: %llu damaged blocks skipped\n", (unsigned long long)rd.torn_blocks);
+    if (rd.seq_gaps) fprintf(stderr, "REC: %llu blocks missing\n", (unsigned long long)rd.seq_gaps);
+    if (rd.seq_regressed) fprintf(stderr, "REC: block numbers went back, stopped after block %llu\n",
+                                  (unsigned long long)(rd.next_seq - 1));
+    fprintf(stderr, "REC: exported %llu frames\n", (unsigned long long)n);
+    can_log_close(&rd);
+    return true;
+}
@@ -0,0 +1,109 @@
+#ifndef CAN_RECORDER_H
+#define CAN_RECORDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Always-on flight recorder. The CAN thread copies every received frame into
+// a preallocated ring (never blocks, drops and counts if full); a background
+// thread drains it into an append-only binary log in whole 4 KiB blocks,
+// normally 64 KiB at a time, and forces the data to disk at least every
+// sync interval. A power loss costs at most that interval plus what is
+// still in the ring.
+//
+// File layout: one header block, then data blocks. Every block is
+// CAN_LOG_BLOCK_SIZE bytes; a data block is a 16 byte header followed by up
+// to CAN_LOG_BLOCK_RECORDS records. Blocks flushed early by a sync are
+// simply not full.
+
+#define CAN_LOG_MAGIC          "MR2CANLG"
+#define CAN_LOG_VERSION        1
+#define CAN_LOG_BLOCK_SIZE     4096
+#define CAN_LOG_BLOCK_MAGIC    0x4B4C4232u     // "2BLK"
+#define CAN_LOG_BLOCK_RECORDS  170
+#define CAN_LOG_EXT            ".mr2log"
+
+#define CAN_RECORDER_DEFAULT_RING_KB 1536
+#define CAN_RECORDER_DEFAULT_SYNC_MS 1000
+#define CAN_RECORDER_DEFAULT_MAX_MB  1024   // About a day of the EMU stream
+#define CAN_RECORDER_FILE_MB         64     // Logs are split at this size
+
+typedef struct {
+    uint64_t stamp_us;      // Monotonic receive time (mono_time_us)
+    uint32_t can_id;        // SocketCAN form, including EFF/RTR/ERR flags
+    uint8_t dlc;
+    uint8_t flags;          // Reserved, 0
+    uint8_t reserved[2];
+    uint8_t data[8];
+} can_log_record_t;
+
+typedef struct {
+    char magic[8];          // CAN_LOG_MAGIC
+    uint32_t version;
+    uint32_t block_size;
+    int64_t realtime_offset_us; // Wall clock - monotonic when the log started
+    uint64_t start_us;      // Monotonic start time
+    char ifname[16];
+} can_log_header_t;
+
+typedef struct {
+    uint32_t magic;         // CAN_LOG_BLOCK_MAGIC
+    uint16_t count;         // Records in this block
+    uint16_t reserved;
+    uint64_t seq;           // Block number, for spotting torn tails
+} can_log_block_t;
+
+_Static_assert(sizeof(can_log_record_t) == 24, "record layout is part of the file format");
+_Static_assert(sizeof(can_log_block_t) + CAN_LOG_BLOCK_RECORDS * sizeof(can_log_record_t) <= CAN_LOG_BLOCK_SIZE,
+               "records must fit a block");
+
+typedef struct {
+    uint64_t frames;        // Frames pushed
+    uint64_t dropped;       // Frames lost because the ring was full
+    uint64_t bytes_written;
+    uint32_t ring_capacity;
+    uint32_t ring_high_water;
+    uint64_t max_write_us;  // Slowest write() / sync seen by the writer thread
+    uint64_t syncs;
+    bool active;
+} can_recorder_stats_t;
+
+// Open <dir>/can-YYYYmmdd-HHMMSS.mr2log (creating dir if needed), allocate a
+// ring of ring_kb and start the writer thread. Call before the CAN thread.
+// A log continues in a new file after CAN_RECORDER_FILE_MB, and the oldest
+// logs in dir are deleted while they take more than max_mb (0 = no limit).
+bool can_recorder_start(const char* dir, const char* ifname, int ring_kb, int sync_ms, int max_mb);
+
+// Flush everything still queued and close the file
+void can_recorder_stop(void);
+
+// CAN thread only. Copies the frame into the ring; no syscalls, no locks.
+void can_recorder_push(uint32_t can_id, uint8_t dlc, const uint8_t* data, uint64_t stamp_us);
+
+void can_recorder_get_stats(can_recorder_stats_t* out);
+void can_recorder_print_stats(void);
+
+// --- Reading logs back ---
+typedef struct {
+    FILE* f;
+    can_log_header_t header;
+    uint8_t block[CAN_LOG_BLOCK_SIZE];
+    int count;
+    int pos;
+    uint64_t next_seq;
+    uint64_t torn_blocks;   // Blocks with a bad header (e.g. cut off by power loss)
+    uint64_t seq_gaps;      // Blocks missing between two read ones
+    bool seq_regressed;     // A block older than the one before: reading stopped there
+} can_log_reader_t;
+
+bool can_log_open(can_log_reader_t* rd, const char* path);
+bool can_log_next(can_log_reader_t* rd, can_log_record_t* out);
+void can_log_close(can_log_reader_t* rd);
+
+// Write a log as candump -l text: "(sec.usec) ifname ID#DATA". Returns false
+// if the log cannot be read.
+bool can_log_export_candump(const char* path, FILE* out);
+
+#endif // CAN_RECORDER_H
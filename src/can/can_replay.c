@@ -0,0 +1,307 @@
+#define _GNU_SOURCE // clock_nanosleep
+#include "can_replay.h"
+#include "can_bus.h"
+#include "can_recorder.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "../util/mono_time.h"
+
+#define REPLAY_FLAT_OUT_BATCH CAN_BATCH_DEFAULT
+
+// SocketCAN ID flags (linux/can.h), spelled out for the portable parser
+#define ID_EFF_FLAG 0x80000000u
+#define ID_RTR_FLAG 0x40000000u
+#define ID_ERR_FLAG 0x20000000u
+
+typedef struct {
+    uint32_t can_id;
+    uint8_t dlc;
+    uint8_t data[8];
+    uint64_t stamp_us;      // Log time
+} replay_frame_t;
+
+// --- SOURCES ---
+static char replay_path[512];
+static double replay_speed = 1.0;
+static const char* replay_if = NULL;
+
+static FILE* text_log = NULL;
+static can_log_reader_t bin_log;
+static bool is_binary = false;
+static uint64_t bad_lines = 0;
+
+static bool source_open(void) {
+    // Recorder logs start with their magic, anything else is treated as candump text
+    FILE* f = fopen(replay_path, "rb");
+    if (!f) {
+        perror("REPLAY: open");
+        return false;
+    }
+    char magic[8] = { 0 };
+    size_t got = fread(magic, 1, sizeof(magic), f);
+    fclose(f);
+
+    is_binary = got == sizeof(magic) && memcmp(magic, CAN_LOG_MAGIC, sizeof(magic)) == 0;
+    if (is_binary) return can_log_open(&bin_log, replay_path);
+
+    text_log = fopen(replay_path, "r");
+    if (!text_log) perror("REPLAY: open");
+    return text_log != NULL;
+}
+
+static int hex_val(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// "(1436509052.249713) can0 123#DEADBEEF", "... 12345678#R", CAN FD "##" is skipped
+static bool parse_candump_line(const char* line, replay_frame_t* out) {
+    unsigned long long sec, usec;
+    char ifname[32], frame[64];
+    if (sscanf(line, " (%llu.%llu) %31s %63s", &sec, &usec, ifname, frame) != 4) return false;
+
+    char* hash = strchr(frame, '#');
+    if (!hash || hash[1] == '#') return false;
+    *hash = '\0';
+
+    size_t id_len = strlen(frame);
+    char* end;
+    unsigned long id = strtoul(frame, &end, 16);
+    if (*end != '\0' || (id_len != 3 && id_len != 8)) return false;
+    if (id_len == 8) out->can_id = (id & ID_ERR_FLAG) ? (uint32_t)id : ((uint32_t)id | ID_EFF_FLAG);
+    else out->can_id = (uint32_t)id;
+
+    memset(out->data, 0, sizeof(out->data));
+    const char* p = hash + 1;
+    if (*p == 'R' || *p == 'r') {
+        out->can_id |= ID_RTR_FLAG;
+        out->dlc = (p[1] >= '0' && p[1] <= '8') ? (uint8_t)(p[1] - '0') : 0;
+    } else {
+        int n = 0;
+        while (p[0] && p[1] && n < 8) {
+            int hi = hex_val(p[0]), lo = hex_val(p[1]);
+            if (hi < 0 || lo < 0) break;
+            out->data[n++] = (uint8_t)(hi << 4 | lo);
+            p += 2;
+        }
+        out->dlc = (uint8_t)n;
+    }
+    out->stamp_us = (uint64_t)sec * 1000000ull + (uint64_t)usec;
+    return true;
+}
+
+static bool source_next(replay_frame_t* out) {
+    if (is_binary) {
+        can_log_record_t rec;
+        if (!can_log_next(&bin_log, &rec)) return false;
+        out->can_id = rec.can_id;
+        out->dlc = rec.dlc;
+        memcpy(out->data, rec.data, sizeof(out->data));
+        out->stamp_us = rec.stamp_us;
+        return true;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), text_log)) {
+        if (parse_candump_line(line, out)) return true;
+        if (line[0] != '\n' && line[0] != '#') bad_lines++;
+    }
+    return false;
+}
+
+static void source_close(void) {
+    if (is_binary) can_log_close(&bin_log);
+    else if (text_log) fclose(text_log);
+    text_log = NULL;
+}
+
+// --- OUTPUT ---
+#ifdef __linux__
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+static int out_socket = -1;
+
+static bool output_open(void) {
+    if (!replay_if) return true;
+
+    out_socket = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (out_socket < 0) {
+        perror("REPLAY: socket");
+        return false;
+    }
+    // Only sending, keep our own receive queue empty
+    setsockopt(out_socket, SOL_CAN_RAW, CAN_RAW_FILTER, NULL, 0);
+
+    struct sockaddr_can addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = (int)if_nametoindex(replay_if);
+    if (addr.can_ifindex == 0 || bind(out_socket, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("REPLAY: bind");
+        close(out_socket);
+        out_socket = -1;
+        return false;
+    }
+    return true;
+}
+
+static bool output_send(const replay_frame_t* f) {
+    struct can_frame cf;
+    memset(&cf, 0, sizeof(cf));
+    cf.can_id = f->can_id;
+    cf.can_dlc = f->dlc;
+    memcpy(cf.data, f->data, sizeof(cf.data));
+
+    while (write(out_socket, &cf, sizeof(cf)) != (ssize_t)sizeof(cf)) {
+        if (errno == ENOBUFS) {
+            // TX queue full (flat out onto vcan): let the receiver catch up
+            usleep(100);
+            continue;
+        }
+        if (errno == EINTR) continue;
+        perror("REPLAY: write");
+        return false;
+    }
+    return true;
+}
+
+static void output_close(void) {
+    if (out_socket >= 0) close(out_socket);
+    out_socket = -1;
+}
+
+static void sleep_until_us(uint64_t t_us) {
+    struct timespec ts = { (time_t)(t_us / 1000000u), (long)(t_us % 1000000u) * 1000 };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {}
+}
+
+#else
+// --- WINDOWS SIMULATION ---
+static bool output_open(void) {
+    if (replay_if) {
+        printf("REPLAY: no SocketCAN here, decoding directly instead of sending to %s.\n", replay_if);
+        replay_if = NULL;
+    }
+    return true;
+}
+
+static bool output_send(const replay_frame_t* f) {
+    (void)f;
+    return false;
+}
+
+static void output_close(void) {
+}
+
+static void sleep_until_us(uint64_t t_us) {
+    uint64_t now = mono_time_us();
+    if (t_us > now) SDL_Delay((Uint32)((t_us - now) / 1000));
+}
+#endif
+
+bool can_replay_setup(const char* path, double speed, const char* out_if) {
+    snprintf(replay_path, sizeof(replay_path), "%s", path);
+    replay_speed = speed > 0.0 ? speed : CAN_REPLAY_MAX_SPEED;
+    replay_if = out_if;
+
+    // Fail early on a missing file, before any thread starts
+    if (!source_open()) return false;
+    source_close();
+    return true;
+}
+
+int can_replay_thread_entry(void* data) {
+    (void)data;
+    bool ok = source_open() && output_open();
+    bool flat_out = replay_speed <= 0.0;
+
+    printf("REPLAY: %s (%s) -> %s, %s\n", replay_path, is_binary ? "recorder log" : "candump",
+           replay_if ? replay_if : "decoder", flat_out ? "flat out" : "timed");
+
+    uint64_t frames = 0, decoded = 0, publishes = 0, max_late_us = 0;
+    uint64_t start_us = mono_time_us();
+    uint64_t first_log_us = 0;
+    bool have_first = false;
+
+    replay_frame_t f;
+    bool more = ok && source_next(&f);
+    while (more) {
+        // One batch: everything already due (or a fixed slice when flat out)
+        int n = 0;
+        uint64_t touched = 0;
+        uint64_t now = mono_time_us();
+        while (more && n < CAN_BATCH_MAX) {
+            if (!have_first) {
+                first_log_us = f.stamp_us;
+                have_first = true;
+            }
+            if (!flat_out) {
+                uint64_t rel = f.stamp_us > first_log_us ? f.stamp_us - first_log_us : 0;
+                uint64_t due = start_us + (uint64_t)((double)rel / replay_speed);
+                if (due > now) {
+                    if (n > 0) break;
+                    sleep_until_us(due);
+                    now = mono_time_us();
+                }
+                if (now > due && now - due > max_late_us) max_late_us = now - due;
+            } else if (n >= REPLAY_FLAT_OUT_BATCH) {
+                break;
+            }
+
+            if (replay_if) {
+                if (!output_send(&f)) {
+                    more = false;
+                    break;
+                }
+            } else {
+                uint64_t t = can_inject_frame(f.can_id, f.dlc, f.data, now);
+                if (t) decoded++;
+                touched |= t;
+            }
+            frames++;
+            n++;
+            more = source_next(&f);
+        }
+        if (!replay_if && n > 0) {
+            can_inject_publish(n, touched);
+            if (touched) publishes++;
+        }
+    }
+
+    double secs = (double)(mono_time_us() - start_us) / 1e6;
+    if (secs <= 0.0) secs = 1e-6;
+    source_close();
+    output_close();
+
+    printf("REPLAY: %llu frames in %.3f s (%.0f frames/s)",
+           (unsigned long long)frames, secs, (double)frames / secs);
+    if (!replay_if) {
+        printf(", %llu decoded (%.0f/s), %llu snapshot publishes (%.0f/s)",
+               (unsigned long long)decoded, (double)decoded / secs,
+               (unsigned long long)publishes, (double)publishes / secs);
+    }
+    printf("\n");
+    if (!flat_out) printf("REPLAY: worst lateness vs. log timing %.2f ms\n", (double)max_late_us / 1000.0);
+    if (bad_lines) printf("REPLAY: %llu unparsable lines skipped\n", (unsigned long long)bad_lines);
+    if (is_binary && bin_log.torn_blocks) printf("REPLAY: %llu damaged blocks skipped\n", (unsigned long long)bin_log.torn_blocks);
+    if (is_binary && bin_log.seq_gaps) printf("REPLAY: %llu blocks missing\n", (unsigned long long)bin_log.seq_gaps);
+    if (is_binary && bin_log.seq_regressed)
+        printf("REPLAY: block numbers went back, stopped after block %llu\n", (unsigned long long)(bin_log.next_seq - 1));
+
+    // Done: close the dashboard so the run ends with its statistics
+    SDL_Event quit;
+    memset(&quit, 0, sizeof(quit));
+    quit.type = SDL_QUIT;
+    SDL_PushEvent(&quit);
+    return 0;
+}
@@ -0,0 +1,22 @@
+#ifndef CAN_REPLAY_H
+#define CAN_REPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Replays a candump -l text log or a recorder .mr2log, either straight into
+// the decoder (can_inject_frame) or onto a CAN interface such as vcan0 for
+// the normal receive path to pick up. Frames are paced by their original
+// timestamps divided by the speed factor; speed 0 sends them flat out.
+// When the log ends the replay prints its statistics and posts SDL_QUIT, so
+// a flat-out replay doubles as a repeatable ingest -> UI benchmark.
+
+#define CAN_REPLAY_MAX_SPEED 0.0
+
+// Call before starting can_replay_thread_entry. out_if NULL = direct to the
+// decoder (use can_init_replay instead of can_init).
+bool can_replay_setup(const char* path, double speed, const char* out_if);
+
+int can_replay_thread_entry(void* data);
+
+#endif // CAN_REPLAY_H
@@ -0,0 +1,269 @@
+#include "dbc_loader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// SocketCAN marks 29-bit IDs with bit 31, and so does the DBC BO_ ID
+#define DBC_EFF_FLAG 0x80000000u
+#define DBC_EFF_MASK 0x1FFFFFFFu
+#define DBC_SFF_MASK 0x000007FFu
+
+// Pseudo message Vector tools use for unassigned signals
+#define DBC_INDEPENDENT_SIG_MSG 0xC0000000u
+
+static bool push_op(dbc_plan_t* plan, int* cap, const dbc_op_t* op) {
+    if (plan->op_count >= 0xFFFF) return false;
+    if (plan->op_count == *cap) {
+        int new_cap = *cap ? *cap * 2 : 64;
+        dbc_op_t* ops = realloc(plan->ops, (size_t)new_cap * sizeof(dbc_op_t));
+        if (!ops) return false;
+        plan->ops = ops;
+        *cap = new_cap;
+    }
+    plan->ops[plan->op_count++] = *op;
+    return true;
+}
+
+static bool push_msg(dbc_plan_t* plan, int* cap, const dbc_msg_t* msg) {
+    if (plan->msg_count == *cap) {
+        int new_cap = *cap ? *cap * 2 : 16;
+        dbc_msg_t* msgs = realloc(plan->msgs, (size_t)new_cap * sizeof(dbc_msg_t));
+        if (!msgs) return false;
+        plan->msgs = msgs;
+        *cap = new_cap;
+    }
+    plan->msgs[plan->msg_count++] = *msg;
+    return true;
+}
+
+// Turn one parsed SG_ line into an op. Returns false if the layout is invalid.
+static bool compile_op(unsigned start, unsigned len, char order, char sign,
+                       float factor, float offset, float min, float max,
+                       int channel, dbc_op_t* op, uint8_t* min_dlc) {
+    if (len < 1 || len > 64 || start > 63) return false;
+
+    memset(op, 0, sizeof(*op));
+    op->mask = (len == 64) ? ~0ull : ((1ull << len) - 1);
+    op->factor = factor;
+    op->offset = offset;
+    op->min = min;
+    op->max = max;
+    op->channel = (uint8_t)channel;
+    if (sign == '-') {
+        op->flags |= DBC_OP_SIGNED;
+        op->sign_bit = 1ull << (len - 1);
+    } else if (sign != '+') {
+        return false;
+    }
+    if (min < max) op->flags |= DBC_OP_CLAMP;
+
+    if (order == '1') {
+        // Intel: start is the LSB, counted from bit 0 of byte 0
+        if (start + len > 64) return false;
+        op->shift = (uint8_t)start;
+        *min_dlc = (uint8_t)((start + len + 7) / 8);
+    } else if (order == '0') {
+        // Motorola: start is the MSB in sawtooth numbering. In the big endian
+        // frame word byte 0 is the top byte, so bit b of byte k sits at
+        // (7 - k) * 8 + b.
+        unsigned msb = (7 - start / 8) * 8 + (start % 8);
+        if (msb + 1 < len) return false;
+        op->shift = (uint8_t)(msb + 1 - len);
+        op->flags |= DBC_OP_BIG_ENDIAN;
+        *min_dlc = (uint8_t)(8 - op->shift / 8);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Close the message being built; messages with no mapped signals are dropped
+static bool finish_msg(dbc_plan_t* plan, int* msg_cap, dbc_msg_t* msg) {
+    if (msg->op_count == 0) return true;
+    if (!push_msg(plan, msg_cap, msg)) return false;
+    if (!(msg->can_id & DBC_EFF_FLAG)) {
+        plan->sff_index[msg->can_id] = (uint16_t)plan->msg_count;
+    }
+    return true;
+}
+
+bool dbc_load(const char* path, dbc_plan_t* plan) {
+    memset(plan, 0, sizeof(*plan));
+
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror("DBC: open");
+        return false;
+    }
+
+    int op_cap = 0, msg_cap = 0;
+    bool in_msg = false;
+    dbc_msg_t msg = { 0 };
+    char line[4096];
+    int line_no = 0;
+    bool ok = true;
+
+    while (ok && fgets(line, sizeof(line), f)) {
+        line_no++;
+        char* p = line;
+        while (*p == ' ' || *p == '\t') p++;
+
+        if (strncmp(p, "BO_ ", 4) == 0) {
+            if (in_msg && !finish_msg(plan, &msg_cap, &msg)) { ok = false; break; }
+            in_msg = false;
+
+            unsigned long id;
+            char name[128];
+            unsigned dlc;
+            if (sscanf(p, "BO_ %lu %127[^: ] : %u", &id, name, &dlc) != 3) {
+                printf("DBC: %s:%d: malformed BO_\n", path, line_no);
+                ok = false;
+                break;
+            }
+            if ((uint32_t)id == DBC_INDEPENDENT_SIG_MSG) continue;
+
+            uint32_t can_id = (uint32_t)id;
+            if (can_id & DBC_EFF_FLAG) {
+                can_id = (can_id & DBC_EFF_MASK) | DBC_EFF_FLAG;
+            } else if (can_id > DBC_SFF_MASK) {
+                printf("DBC: %s:%d: standard ID 0x%X out of range\n", path, line_no, can_id);
+                ok = false;
+                break;
+            }
+            if (!(can_id & DBC_EFF_FLAG) && plan->sff_index[can_id]) {
+                printf("DBC: %s:%d: duplicate message 0x%X\n", path, line_no, can_id);
+                ok = false;
+                break;
+            }
+
+            memset(&msg, 0, sizeof(msg));
+            msg.can_id = can_id;
+            msg.first_op = (uint16_t)plan->op_count;
+            in_msg = true;
+        } else if (strncmp(p, "SG_ ", 4) == 0) {
+            if (!in_msg) {
+                plan->skipped_signals++;
+                continue;
+            }
+
+            // SG_ <name> [M|m<n>] : <start>|<len>@<order><sign> (<factor>,<offset>) [<min>|<max>] ...
+            char* colon = strchr(p, ':');
+            char name[128], mux[16] = "";
+            unsigned start, len;
+            char order, sign;
+            float factor, offset, min, max;
+            if (!colon) {
+                printf("DBC: %s:%d: malformed SG_\n", path, line_no);
+                ok = false;
+                break;
+            }
+            *colon = '\0';
+            if (sscanf(p + 4, "%127s %15s", name, mux) < 1 ||
+                sscanf(colon + 1, " %u|%u@%c%c (%f,%f) [%f|%f]",
+                       &start, &len, &order, &sign, &factor, &offset, &min, &max) != 8) {
+                printf("DBC: %s:%d: malformed SG_\n", path, line_no);
+                ok = false;
+                break;
+            }
+
+            // Multiplexed signals are not supported; the multiplexor itself is fine
+            int channel = can_channel_from_name(name);
+            if (mux[0] == 'm' || channel < 0) {
+                plan->skipped_signals++;
+                continue;
+            }
+
+            dbc_op_t op;
+            uint8_t min_dlc;
+            if (!compile_op(start, len, order, sign, factor, offset, min, max, channel, &op, &min_dlc)) {
+                printf("DBC: %s:%d: bad layout for signal %s\n", path, line_no, name);
+                ok = false;
+                break;
+            }
+            if (msg.op_count == 0xFF || !push_op(plan, &op_cap, &op)) {
+                printf("DBC: %s:%d: too many signals\n", path, line_no);
+                ok = false;
+                break;
+            }
+            msg.op_count++;
+            if (min_dlc > msg.min_dlc) msg.min_dlc = min_dlc;
+            if (op.flags & DBC_OP_BIG_ENDIAN) msg.need_be = 1;
+            else msg.need_le = 1;
+        }
+        // Everything else (VERSION, BU_, CM_, BA_, VAL_, ...) is not needed for decoding
+    }
+    if (ok && in_msg) ok = finish_msg(plan, &msg_cap, &msg);
+    fclose(f);
+
+    if (!ok) dbc_free(plan);
+    return ok;
+}
+
+void dbc_free(dbc_plan_t* plan) {
+    free(plan->msgs);
+    free(plan->ops);
+    memset(plan, 0, sizeof(*plan));
+}
+
+static int find_msg(const dbc_plan_t* plan, uint32_t can_id) {
+    if (!(can_id & DBC_EFF_FLAG)) {
+        return (can_id <= DBC_SFF_MASK) ? (int)plan->sff_index[can_id] - 1 : -1;
+    }
+    // Extended IDs are rare in dash configs, a linear scan is fine
+    for (int i = 0; i < plan->msg_count; i++) {
+        if (plan->msgs[i].can_id == can_id) return i;
+    }
+    return -1;
+}
+
+dbc_result_t dbc_decode(const dbc_plan_t* plan, uint32_t can_id, uint8_t dlc,
+                        const uint8_t* data, float* values, uint64_t* touched) {
+    int idx = find_msg(plan, can_id);
+    if (idx < 0) return DBC_FRAME_IGNORED;
+
+    const dbc_msg_t* msg = &plan->msgs[idx];
+    if (dlc < msg->min_dlc) return DBC_FRAME_BAD_DLC;
+
+    uint8_t buf[8] = { 0 };
+    memcpy(buf, data, dlc > 8 ? 8 : dlc);
+
+    uint64_t le = 0, be = 0;
+    if (msg->need_le) {
+        for (int i = 7; i >= 0; i--) le = (le << 8) | buf[i];
+    }
+    if (msg->need_be) {
+        for (int i = 0; i < 8; i++) be = (be << 8) | buf[i];
+    }
+
+    uint64_t mask = 0;
+    const dbc_op_t* op = &plan->ops[msg->first_op];
+    for (uint8_t i = 0; i < msg->op_count; i++, op++) {
+        uint64_t word = (op->flags & DBC_OP_BIG_ENDIAN) ? be : le;
+        uint64_t raw = (word >> op->shift) & op->mask;
+
+        float v;
+        if (raw & op->sign_bit) {
+            v = (float)(int64_t)(raw | ~op->mask);
+        } else {
+            v = (float)raw;
+        }
+        v = v * op->factor + op->offset;
+        if (op->flags & DBC_OP_CLAMP) {
+            if (v < op->min) v = op->min;
+            if (v > op->max) v = op->max;
+        }
+
+        values[op->channel] = v;
+        mask |= 1ull << op->channel;
+    }
+    *touched |= mask;
+    return DBC_FRAME_DECODED;
+}
+
+int dbc_plan_ids(const dbc_plan_t* plan, uint32_t* ids, int max) {
+    int n = 0;
+    for (int i = 0; i < plan->msg_count && n < max; i++) {
+        ids[n++] = plan->msgs[i].can_id;
+    }
+    return n;
+}
@@ -0,0 +1,64 @@
+#ifndef DBC_LOADER_H
+#define DBC_LOADER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "can_bus.h"
+
+// Loads a .dbc file once at startup and compiles every signal whose name
+// matches a can_channel_t (see can_channel_from_name) into a flat decode plan:
+// precomputed shift/mask/scale ops per message, found through an ID index.
+// Nothing on the decode path touches strings.
+
+#define DBC_OP_SIGNED     0x01
+#define DBC_OP_BIG_ENDIAN 0x02  // Motorola byte order
+#define DBC_OP_CLAMP      0x04  // DBC gave a [min|max] range
+
+typedef struct {
+    uint64_t mask;      // (1 << length) - 1
+    uint64_t sign_bit;  // Top bit of the field, 0 if unsigned
+    float factor;
+    float offset;
+    float min;
+    float max;
+    uint8_t shift;      // Right shift of the LE (or BE) frame word
+    uint8_t flags;      // DBC_OP_*
+    uint8_t channel;    // can_channel_t
+} dbc_op_t;
+
+typedef struct {
+    uint32_t can_id;    // SocketCAN form (CAN_EFF_FLAG set for extended IDs)
+    uint16_t first_op;
+    uint8_t op_count;
+    uint8_t min_dlc;    // Bytes covered by the signals
+    uint8_t need_le;    // Some op reads the little endian word
+    uint8_t need_be;    // Some op reads the big endian word
+} dbc_msg_t;
+
+typedef struct {
+    dbc_msg_t* msgs;
+    dbc_op_t* ops;
+    int msg_count;
+    int op_count;
+    int skipped_signals;        // Unknown names or unsupported (multiplexed) signals
+    uint16_t sff_index[2048];   // Standard ID -> msg index + 1 (0 = not in plan)
+} dbc_plan_t;
+
+typedef enum {
+    DBC_FRAME_IGNORED = 0,
+    DBC_FRAME_DECODED,
+    DBC_FRAME_BAD_DLC
+} dbc_result_t;
+
+// Parse and compile. Returns false (and prints why) on I/O or syntax errors.
+bool dbc_load(const char* path, dbc_plan_t* plan);
+void dbc_free(dbc_plan_t* plan);
+
+// Same contract as emu_decode()
+dbc_result_t dbc_decode(const dbc_plan_t* plan, uint32_t can_id, uint8_t dlc,
+                        const uint8_t* data, float* values, uint64_t* touched);
+
+// IDs in the plan (for kernel filters). Returns the count written.
+int dbc_plan_ids(const dbc_plan_t* plan, uint32_t* ids, int max);
+
+#endif // DBC_LOADER_H
@@ -0,0 +1,145 @@
+#include "emu_decoder.h"
+#include <stddef.h>
+
+_Static_assert(CAN_CH_COUNT <= 64, "touched mask is 64 bits");
+
+// One signal inside a frame. Raw value is little endian, then
+// value = raw * scale + bias, clamped to [min, max].
+typedef struct {
+    uint8_t channel;    // can_channel_t
+    uint8_t offset;     // First data byte
+    uint8_t width;      // 1 or 2 bytes
+    uint8_t is_signed;
+    float scale;
+    float bias;
+    float min;
+    float max;
+} emu_signal_t;
+
+typedef struct {
+    const emu_signal_t* signals;
+    uint8_t count;
+    uint8_t min_dlc;
+} emu_frame_t;
+
+#define U8  1, 0
+#define S8  1, 1
+#define U16 2, 0
+#define S16 2, 1
+
+// --- SIGNAL TABLE (layout from EMUcan.h / EMU Black CAN stream) ---
+static const emu_signal_t frame_0[] = {
+    { CAN_CH_RPM,        0, U16, 1.0f,       0.0f,   0.0f, 12000.0f },
+    { CAN_CH_TPS,        2, U8,  0.5f,       0.0f,   0.0f,   100.0f },
+    { CAN_CH_IAT,        3, S8,  1.0f,       0.0f, -40.0f,   150.0f },
+    { CAN_CH_MAP,        4, U16, 1.0f,       0.0f,   0.0f,   600.0f },
+    { CAN_CH_BOOST,      4, U16, 0.01f,     -1.0f,  -1.0f,     4.0f },
+    { CAN_CH_INJ_PW,     6, U16, 0.016129f,  0.0f,   0.0f,    50.0f },
+};
+static const emu_signal_t frame_1[] = {
+    { CAN_CH_AIN1, 0, U16, 0.0048828125f, 0.0f, 0.0f, 5.0f },
+    { CAN_CH_AIN2, 2, U16, 0.0048828125f, 0.0f, 0.0f, 5.0f },
+    { CAN_CH_AIN3, 4, U16, 0.0048828125f, 0.0f, 0.0f, 5.0f },
+    { CAN_CH_AIN4, 6, U16, 0.0048828125f, 0.0f, 0.0f, 5.0f },
+};
+static const emu_signal_t frame_2[] = {
+    { CAN_CH_SPEED,      0, U16, 1.0f,     0.0f,   0.0f, 400.0f },
+    { CAN_CH_BARO,       2, U8,  1.0f,     0.0f,  50.0f, 130.0f },
+    { CAN_CH_OIL_TEMP,   3, U8,  1.0f,     0.0f,   0.0f, 160.0f },
+    { CAN_CH_OIL_PRESS,  4, U8,  0.0625f,  0.0f,   0.0f,  12.0f },
+    { CAN_CH_FUEL_PRESS, 5, U8,  0.03125f, 0.0f,   0.0f,   8.0f },
+    { CAN_CH_CLT,        6, S16, 1.0f,     0.0f, -40.0f, 250.0f },
+};
+static const emu_signal_t frame_3[] = {
+    { CAN_CH_IGN_ANGLE,   0, S8,  0.5f,       0.0f, -60.0f,   60.0f },
+    { CAN_CH_DWELL,       1, U8,  0.05f,      0.0f,   0.0f,   10.0f },
+    { CAN_CH_LAMBDA,      2, U8,  0.0078125f, 0.0f,   0.0f,    2.0f },
+    { CAN_CH_LAMBDA_CORR, 3, U8,  0.5f,       0.0f,  75.0f,  125.0f },
+    { CAN_CH_EGT,         4, U16, 1.0f,       0.0f,   0.0f, 1200.0f },
+    { CAN_CH_EGT2,        6, U16, 1.0f,       0.0f,   0.0f, 1200.0f },
+};
+static const emu_signal_t frame_4[] = {
+    { CAN_CH_GEAR,     0, S8,  1.0f,   0.0f,  -1.0f,    10.0f },
+    { CAN_CH_ECU_TEMP, 1, S8,  1.0f,   0.0f, -40.0f,   127.0f },
+    { CAN_CH_BATT,     2, U16, 0.027f, 0.0f,   0.0f,    30.0f },
+    { CAN_CH_CEL,      4, U16, 1.0f,   0.0f,   0.0f, 65535.0f },
+    { CAN_CH_FLAGS1,   6, U8,  1.0f,   0.0f,   0.0f,   255.0f },
+    { CAN_CH_ETHANOL,  7, U8,  1.0f,   0.0f,   0.0f,   100.0f },
+};
+static const emu_signal_t frame_5[] = {
+    { CAN_CH_DBW_POS,         0, U8,  0.5f, 0.0f, 0.0f,   100.0f },
+    { CAN_CH_DBW_TARGET,      1, U8,  0.5f, 0.0f, 0.0f,   100.0f },
+    { CAN_CH_TC_DRPM_RAW,     2, U16, 1.0f, 0.0f, 0.0f, 65535.0f },
+    { CAN_CH_TC_DRPM,         4, U16, 1.0f, 0.0f, 0.0f, 65535.0f },
+    { CAN_CH_TC_TORQUE_RED,   6, U8,  1.0f, 0.0f, 0.0f,   100.0f },
+    { CAN_CH_PIT_TORQUE_RED,  7, U8,  1.0f, 0.0f, 0.0f,   100.0f },
+};
+static const emu_signal_t frame_6[] = {
+    { CAN_CH_AIN5,      0, U16, 0.0048828125f, 0.0f, 0.0f,   5.0f },
+    { CAN_CH_AIN6,      2, U16, 0.0048828125f, 0.0f, 0.0f,   5.0f },
+    { CAN_CH_OUTFLAGS1, 4, U8,  1.0f,          0.0f, 0.0f, 255.0f },
+    { CAN_CH_OUTFLAGS2, 5, U8,  1.0f,          0.0f, 0.0f, 255.0f },
+    { CAN_CH_OUTFLAGS3, 6, U8,  1.0f,          0.0f, 0.0f, 255.0f },
+    { CAN_CH_OUTFLAGS4, 7, U8,  1.0f,          0.0f, 0.0f, 255.0f },
+};
+static const emu_signal_t frame_7[] = {
+    { CAN_CH_BOOST_TARGET,  0, U16, 1.0f,  0.0f, 0.0f, 600.0f },
+    { CAN_CH_PWM1,          2, U8,  1.0f,  0.0f, 0.0f, 100.0f },
+    { CAN_CH_DSG_MODE,      3, U8,  1.0f,  0.0f, 0.0f,  15.0f },
+    { CAN_CH_LAMBDA_TARGET, 4, U8,  0.01f, 0.0f, 0.0f,   2.55f },
+    { CAN_CH_PWM2,          5, U8,  1.0f,  0.0f, 0.0f, 100.0f },
+    { CAN_CH_FUEL_USED,     6, U16, 0.01f, 0.0f, 0.0f, 655.35f },
+};
+
+#define FRAME(sigs) { sigs, (uint8_t)(sizeof(sigs) / sizeof(sigs[0])), 8 }
+
+// Indexed by can_id - base
+static const emu_frame_t emu_frames[EMU_FRAME_COUNT] = {
+    FRAME(frame_0), FRAME(frame_1), FRAME(frame_2), FRAME(frame_3),
+    FRAME(frame_4), FRAME(frame_5), FRAME(frame_6), FRAME(frame_7),
+};
+
+void emu_decoder_init(emu_decoder_t* dec, uint32_t base) {
+    dec->base = base;
+}
+
+emu_result_t emu_decode(const emu_decoder_t* dec, uint32_t can_id, uint8_t dlc,
+                        const uint8_t* data, float* values, uint64_t* touched) {
+    // Unsigned wrap makes IDs below base land out of range too
+    uint32_t idx = can_id - dec->base;
+    if (idx >= EMU_FRAME_COUNT) return EMU_FRAME_IGNORED;
+
+    const emu_frame_t* frame = &emu_frames[idx];
+    if (dlc < frame->min_dlc) return EMU_FRAME_BAD_DLC;
+
+    uint64_t mask = 0;
+    for (uint8_t i = 0; i < frame->count; i++) {
+        const emu_signal_t* sig = &frame->signals[i];
+
+        int32_t raw;
+        if (sig->width == 2) {
+            uint16_t u = (uint16_t)data[sig->offset] | ((uint16_t)data[sig->offset + 1] << 8);
+            raw = sig->is_signed ? (int32_t)(int16_t)u : (int32_t)u;
+        } else {
+            uint8_t u = data[sig->offset];
+            raw = sig->is_signed ? (int32_t)(int8_t)u : (int32_t)u;
+        }
+
+        float v = (float)raw * sig->scale + sig->bias;
+        if (v < sig->min) v = sig->min;
+        if (v > sig->max) v = sig->max;
+
+        values[sig->channel] = v;
+        mask |= 1ull << sig->channel;
+    }
+    *touched |= mask;
+    return EMU_FRAME_DECODED;
+}
+
+int emu_decoder_ids(const emu_decoder_t* dec, uint32_t* ids, int max) {
+    int n = 0;
+    for (uint32_t i = 0; i < EMU_FRAME_COUNT && n < max; i++) {
+        ids[n++] = dec->base + i;
+    }
+    return n;
+}
@@ -0,0 +1,33 @@
+#ifndef EMU_DECODER_H
+#define EMU_DECODER_H
+
+#include <stdint.h>
+#include "can_bus.h"
+
+// Portable, table-driven decoder for the Ecumaster EMU Black CAN stream.
+// The ECU sends 8 frames at base..base+7; frame layout follows EMUcan.h.
+
+#define EMU_DEFAULT_BASE  0x600
+#define EMU_FRAME_COUNT   8
+
+typedef struct {
+    uint32_t base;      // Same meaning as EMUcan(EMUbase)
+} emu_decoder_t;
+
+typedef enum {
+    EMU_FRAME_IGNORED = 0,  // Not an EMU frame
+    EMU_FRAME_DECODED,
+    EMU_FRAME_BAD_DLC       // EMU ID but too short for its signals
+} emu_result_t;
+
+void emu_decoder_init(emu_decoder_t* dec, uint32_t base);
+
+// Decode one frame into values[] (indexed by can_channel_t) and set the bit of
+// every channel written in *touched.
+emu_result_t emu_decode(const emu_decoder_t* dec, uint32_t can_id, uint8_t dlc,
+                        const uint8_t* data, float* values, uint64_t* touched);
+
+// IDs this decoder consumes (for kernel filters). Returns the count written.
+int emu_decoder_ids(const emu_decoder_t* dec, uint32_t* ids, int max);
+
+#endif // EMU_DECODER_H
@@ -0,0 +1,577 @@
+#include "drm_display.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <SDL.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <drm/drm.h>
+#include <drm/drm_mode.h>
+#include "../util/mono_time.h"
+#include "../util/histogram.h"
+
+typedef struct {
+    uint32_t handle;
+    uint32_t fb_id;
+    uint8_t* map;
+    uint64_t size;
+    // Bounding box of everything drawn into other buffers since this one
+    // was last rendered, i.e. what it is missing
+    bool damaged;
+    int dx1, dy1, dx2, dy2;
+} drm_buffer_t;
+
+static int drm_fd = -1;
+static drm_buffer_t bufs[DRM_DISPLAY_MAX_BUFFERS];
+static int num_bufs = 0;
+static int mode_w = 0, mode_h = 0;
+static int px_bytes = 4;            // 4 = XRGB8888, 2 = RGB565
+static uint32_t crtc_id = 0;
+static uint32_t connector_id = 0;
+static struct drm_mode_crtc saved_crtc;
+static bool saved_crtc_valid = false;
+static bool event_time_mono = false;    // Flip timestamps are CLOCK_MONOTONIC
+
+// Buffer roles, shared by the render loop and the flip thread under lock
+static SDL_mutex* lock = NULL;
+static SDL_sem* flip_sem = NULL;        // Posted on every completed flip
+static int front = 0;                   // Being scanned out
+static int queued = -1;                 // Flip submitted, lands at the next vblank
+static int ready = -1;                  // Complete, flips after the queued one
+static int back = -1;                   // Being rendered (render loop only)
+static uint64_t queued_end_us, queued_rx_us;
+static uint64_t ready_end_us, ready_rx_us;
+
+static SDL_Thread* flip_thread = NULL;
+static atomic_bool flip_thread_stop = false;
+static atomic_uint notify_event = 0;
+
+// --- STATISTICS ---
+static histogram_t end_to_scanout;      // Frame complete -> flip done (us)
+static histogram_t rx_to_scanout;       // CAN frame received -> on screen (us)
+static histogram_t flip_interval;       // Between completed flips (us)
+static uint64_t last_flip_us = 0;
+static uint64_t frames_ended = 0;
+static uint64_t flips = 0;
+static uint64_t frames_replaced = 0;    // Complete frames superseded before their flip
+static uint64_t flip_errors = 0;
+static uint64_t render_waits = 0;       // begin_frame calls that had to wait for a buffer
+static uint64_t render_wait_us = 0;
+static uint64_t sync_bytes = 0;         // Copied to bring back buffers up to date
+static uint64_t start_us = 0;
+
+// Called with lock held
+static bool submit_flip(int i, uint64_t end_us, uint64_t rx_us) {
+    struct drm_mode_crtc_page_flip flip;
+    memset(&flip, 0, sizeof(flip));
+    flip.crtc_id = crtc_id;
+    flip.fb_id = bufs[i].fb_id;
+    flip.flags = DRM_MODE_PAGE_FLIP_EVENT;
+    flip.user_data = (uint64_t)i;
+    if (ioctl(drm_fd, DRM_IOCTL_MODE_PAGE_FLIP, &flip) != 0) {
+        if (flip_errors++ == 0) perror("DRM: Page flip failed");
+        return false;
+    }
+    queued = i;
+    queued_end_us = end_us;
+    queued_rx_us = rx_us;
+    return true;
+}
+
+static void flip_complete(const struct drm_event_vblank* vb) {
+    uint64_t t = event_time_mono ? (uint64_t)vb->tv_sec * 1000000u + vb->tv_usec : mono_time_us();
+
+    SDL_LockMutex(lock);
+    if (queued == (int)vb->user_data) {
+        front = queued;
+        queued = -1;
+        flips++;
+        histogram_add(&end_to_scanout, t > queued_end_us ? t - queued_end_us : 0);
+        if (queued_rx_us) histogram_add(&rx_to_scanout, t > queued_rx_us ? t - queued_rx_us : 0);
+        if (last_flip_us) histogram_add(&flip_interval, t - last_flip_us);
+        last_flip_us = t;
+
+        // The next complete frame goes out at the following vblank
+        if (ready >= 0) {
+            int r = ready;
+            ready = -1;
+            submit_flip(r, ready_end_us, ready_rx_us);
+        }
+    }
+    SDL_UnlockMutex(lock);
+
+    SDL_SemPost(flip_sem);
+    uint32_t type = atomic_load(&notify_event);
+    if (type) {
+        SDL_Event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.type = type;
+        SDL_PushEvent(&ev);
+    }
+}
+
+// Reads flip-complete events, so flips are chained without the render loop
+static int flip_thread_entry(void* data) {
+    (void)data;
+    uint64_t buf[128];      // drm_event records, 8 byte aligned
+    struct pollfd pfd = { .fd = drm_fd, .events = POLLIN };
+
+    while (!atomic_load(&flip_thread_stop)) {
+        if (poll(&pfd, 1, 100) <= 0) continue;
+        ssize_t n = read(drm_fd, buf, sizeof(buf));
+        ssize_t off = 0;
+        while (off + (ssize_t)sizeof(struct drm_event) <= n) {
+            const struct drm_event* ev = (const struct drm_event*)((const uint8_t*)buf + off);
+            if (ev->length < sizeof(*ev)) break;
+            if (ev->type == DRM_EVENT_FLIP_COMPLETE && ev->length >= sizeof(struct drm_event_vblank))
+                flip_complete((const struct drm_event_vblank*)ev);
+            off += ev->length;
+        }
+    }
+    return 0;
+}
+
+// --- MODE SETTING ---
+static bool get_encoder(uint32_t id, struct drm_mode_get_encoder* enc) {
+    memset(enc, 0, sizeof(*enc));
+    enc->encoder_id = id;
+    return ioctl(drm_fd, DRM_IOCTL_MODE_GETENCODER, enc) == 0;
+}
+
+// CRTC for a connector: the one it is driven by now, else the first its
+// encoders can use
+static uint32_t find_crtc(uint32_t current_encoder, const uint32_t* encoders, uint32_t n_enc,
+                          const uint32_t* crtcs, uint32_t n_crtc) {
+    struct drm_mode_get_encoder enc;
+    if (current_encoder && get_encoder(current_encoder, &enc) && enc.crtc_id) return enc.crtc_id;
+
+    for (uint32_t e = 0; e < n_enc; e++) {
+        if (!get_encoder(encoders[e], &enc)) continue;
+        for (uint32_t c = 0; c < n_crtc && c < 32; c++) {
+            if (enc.possible_crtcs & (1u << c)) return crtcs[c];
+        }
+    }
+    return 0;
+}
+
+static bool pick_output(int want_w, int want_h, struct drm_mode_modeinfo* mode) {
+    struct drm_mode_card_res res;
+    memset(&res, 0, sizeof(res));
+    if (ioctl(drm_fd, DRM_IOCTL_MODE_GETRESOURCES, &res) != 0) {
+        perror("DRM: Failed to get resources (not a KMS device?)");
+        return false;
+    }
+    uint32_t* conns = calloc(res.count_connectors + 1, sizeof(uint32_t));
+    uint32_t* crtcs = calloc(res.count_crtcs + 1, sizeof(uint32_t));
+    bool found = false;
+    if (!conns || !crtcs) goto out;
+
+    res.count_fbs = 0;
+    res.count_encoders = 0;
+    res.connector_id_ptr = (uint64_t)(uintptr_t)conns;
+    res.crtc_id_ptr = (uint64_t)(uintptr_t)crtcs;
+    if (ioctl(drm_fd, DRM_IOCTL_MODE_GETRESOURCES, &res) != 0) goto out;
+
+    for (uint32_t i = 0; i < res.count_connectors && !found; i++) {
+        struct drm_mode_get_connector conn;
+        memset(&conn, 0, sizeof(conn));
+        conn.connector_id = conns[i];
+        if (ioctl(drm_fd, DRM_IOCTL_MODE_GETCONNECTOR, &conn) != 0) continue;
+        if (conn.connection != DRM_MODE_CONNECTED || conn.count_modes == 0) continue;
+
+        struct drm_mode_modeinfo* modes = calloc(conn.count_modes, sizeof(*modes));
+        uint32_t* encs = calloc(conn.count_encoders + 1, sizeof(uint32_t));
+        uint32_t n_modes = conn.count_modes, n_encs = conn.count_encoders;
+        if (modes && encs) {
+            conn.count_props = 0;
+            conn.modes_ptr = (uint64_t)(uintptr_t)modes;
+            conn.encoders_ptr = (uint64_t)(uintptr_t)encs;
+            // Counts that grew in between (hotplug) leave the arrays unfilled
+            if (ioctl(drm_fd, DRM_IOCTL_MODE_GETCONNECTOR, &conn) == 0 && conn.count_modes
+                && conn.count_modes <= n_modes && conn.count_encoders <= n_encs) {
+                // Exact size first, then the preferred mode, then whatever is first
+                int pick = -1;
+                for (uint32_t m = 0; m < conn.count_modes && pick < 0; m++)
+                    if (modes[m].hdisplay == want_w && modes[m].vdisplay == want_h) pick = (int)m;
+                for (uint32_t m = 0; m < conn.count_modes && pick < 0; m++)
+                    if (modes[m].type & DRM_MODE_TYPE_PREFERRED) pick = (int)m;
+                if (pick < 0) pick = 0;
+
+                uint32_t crtc = find_crtc(conn.encoder_id, encs, conn.count_encoders, crtcs, res.count_crtcs);
+                if (crtc) {
+                    *mode = modes[pick];
+                    crtc_id = crtc;
+                    connector_id = conn.connector_id;
+                    found = true;
+                }
+            }
+        }
+        free(modes);
+        free(encs);
+    }
+    if (!found) printf("DRM: No connected output with a usable CRTC.\n");
+
+out:
+    free(conns);
+    free(crtcs);
+    return found;
+}
+
+static bool create_buffer(drm_buffer_t* b) {
+    struct drm_mode_create_dumb create;
+    memset(&create, 0, sizeof(create));
+    create.width = (uint32_t)mode_w;
+    create.height = (uint32_t)mode_h;
+    create.bpp = (uint32_t)px_bytes * 8;
+    if (ioctl(drm_fd, DRM_IOCTL_MODE_CREATE_DUMB, &create) != 0) {
+        perror("DRM: Failed to create dumb buffer");
+        return false;
+    }
+    b->handle = create.handle;
+    b->size = create.size;
+    if (create.pitch != (uint32_t)(mode_w * px_bytes)) {
+        // LVGL draws with a stride of exactly width * pixel size
+        printf("DRM: Buffer pitch %u, LVGL needs %d.\n", create.pitch, mode_w * px_bytes);
+        return false;
+    }
+
+    struct drm_mode_fb_cmd fb;
+    memset(&fb, 0, sizeof(fb));
+    fb.width = (uint32_t)mode_w;
+    fb.height = (uint32_t)mode_h;
+    fb.pitch = create.pitch;
+    // XRGB8888 / RGB565, same memory layout as LVGL's ARGB8888 / RGB565
+    fb.bpp = (uint32_t)px_bytes * 8;
+    fb.depth = px_bytes == 2 ? 16 : 24;
+    fb.handle = b->handle;
+    if (ioctl(drm_fd, DRM_IOCTL_MODE_ADDFB, &fb) != 0) {
+        perror("DRM: Failed to add framebuffer");
+        return false;
+    }
+    b->fb_id = fb.fb_id;
+
+    struct drm_mode_map_dumb map;
+    memset(&map, 0, sizeof(map));
+    map.handle = b->handle;
+    if (ioctl(drm_fd, DRM_IOCTL_MODE_MAP_DUMB, &map) != 0) {
+        perror("DRM: Failed to map dumb buffer");
+        return false;
+    }
+    void* p = mmap(NULL, (size_t)b->size, PROT_READ | PROT_WRITE, MAP_SHARED, drm_fd, (off_t)map.offset);
+    if (p == MAP_FAILED) {
+        perror("DRM: mmap failed");
+        return false;
+    }
+    b->map = p;
+    memset(b->map, 0, (size_t)b->size);
+    b->damaged = false;
+    return true;
+}
+
+bool drm_display_init(const char* card, int width, int height, int num_buffers, int bpp) {
+    if (num_buffers < 2) num_buffers = 2;
+    if (num_buffers > DRM_DISPLAY_MAX_BUFFERS) num_buffers = DRM_DISPLAY_MAX_BUFFERS;
+    px_bytes = bpp == 16 ? 2 : 4;
+
+    drm_fd = open(card, O_RDWR | O_CLOEXEC);
+    if (drm_fd < 0) {
+        perror("DRM: Failed to open card");
+        return false;
+    }
+
+    struct drm_get_cap cap = { .capability = DRM_CAP_DUMB_BUFFER, .value = 0 };
+    if (ioctl(drm_fd, DRM_IOCTL_GET_CAP, &cap) != 0 || !cap.value) {
+        printf("DRM: %s does not support dumb buffers.\n", card);
+        drm_display_close();
+        return false;
+    }
+    cap.capability = DRM_CAP_TIMESTAMP_MONOTONIC;
+    cap.value = 0;
+    event_time_mono = ioctl(drm_fd, DRM_IOCTL_GET_CAP, &cap) == 0 && cap.value;
+
+    struct drm_mode_modeinfo mode;
+    if (!pick_output(width, height, &mode)) {
+        drm_display_close();
+        return false;
+    }
+    mode_w = mode.hdisplay;
+    mode_h = mode.vdisplay;
+
+    for (num_bufs = 0; num_bufs < num_buffers; num_bufs++) {
+        if (!create_buffer(&bufs[num_bufs])) {
+            num_bufs++;     // Release what was created of it
+            drm_display_close();
+            return false;
+        }
+    }
+
+    memset(&saved_crtc, 0, sizeof(saved_crtc));
+    saved_crtc.crtc_id = crtc_id;
+    saved_crtc_valid = ioctl(drm_fd, DRM_IOCTL_MODE_GETCRTC, &saved_crtc) == 0;
+
+    struct drm_mode_crtc set;
+    memset(&set, 0, sizeof(set));
+    set.crtc_id = crtc_id;
+    set.fb_id = bufs[0].fb_id;
+    set.set_connectors_ptr = (uint64_t)(uintptr_t)&connector_id;
+    set.count_connectors = 1;
+    set.mode = mode;
+    set.mode_valid = 1;
+    if (ioctl(drm_fd, DRM_IOCTL_MODE_SETCRTC, &set) != 0) {
+        perror("DRM: Failed to set mode (is another program DRM master?)");
+        saved_crtc_valid = false;
+        drm_display_close();
+        return false;
+    }
+    front = 0;
+    queued = ready = back = -1;
+
+    histogram_reset(&end_to_scanout);
+    histogram_reset(&rx_to_scanout);
+    histogram_reset(&flip_interval);
+    start_us = mono_time_us();
+
+    lock = SDL_CreateMutex();
+    flip_sem = SDL_CreateSemaphore(0);
+    atomic_store(&flip_thread_stop, false);
+    flip_thread = lock && flip_sem ? SDL_CreateThread(flip_thread_entry, "DRMFlip", NULL) : NULL;
+    if (!flip_thread) {
+        printf("DRM: Failed to start flip thread (%s).\n", SDL_GetError());
+        drm_display_close();
+        return false;
+    }
+
+    printf("DRM: %s %dx%d@%uHz, connector %u, crtc %u, %d x %zu KiB %s buffers\n",
+           card, mode_w, mode_h, mode.vrefresh, connector_id, crtc_id, num_bufs,
+           (size_t)bufs[0].size / 1024, px_bytes == 2 ? "RGB565" : "XRGB8888");
+    return true;
+}
+
+int drm_display_width(void) { return mode_w; }
+int drm_display_height(void) { return mode_h; }
+
+void drm_display_set_notify_event(uint32_t sdl_event_type) {
+    atomic_store(&notify_event, sdl_event_type == (uint32_t)-1 ? 0 : sdl_event_type);
+}
+
+// Called with lock held
+static int find_free(void) {
+    for (int i = 0; i < num_bufs; i++) {
+        if (i != front && i != queued && i != ready) return i;
+    }
+    return -1;
+}
+
+bool drm_display_can_render(void) {
+    if (drm_fd < 0) return false;
+    SDL_LockMutex(lock);
+    bool ok = find_free() >= 0;
+    SDL_UnlockMutex(lock);
+    return ok;
+}
+
+#define SYNC_MAX_SPANS 32
+
+// Copy row y, columns x1..x2, from src into dst, leaving out the parts the
+// frame redraws anyway
+static void sync_row(uint8_t* dst, const uint8_t* src, int y, int x1, int x2,
+                     const drm_rect_t* areas, int count) {
+    // Spans of this row that get redrawn, sorted by start
+    int sx1[SYNC_MAX_SPANS], sx2[SYNC_MAX_SPANS];
+    int n = 0;
+    for (int i = 0; i < count && n < SYNC_MAX_SPANS; i++) {
+        const drm_rect_t* a = &areas[i];
+        if (y < a->y1 || y > a->y2 || a->x2 < x1 || a->x1 > x2) continue;
+        int j = n++;
+        while (j > 0 && sx1[j - 1] > a->x1) {
+            sx1[j] = sx1[j - 1];
+            sx2[j] = sx2[j - 1];
+            j--;
+        }
+        sx1[j] = a->x1;
+        sx2[j] = a->x2;
+    }
+
+    size_t off = (size_t)y * (size_t)mode_w * px_bytes;
+    int x = x1;
+    for (int i = 0; i <= n && x <= x2; i++) {
+        int gap_end = i < n ? sx1[i] - 1 : x2;
+        if (gap_end > x2) gap_end = x2;
+        if (gap_end >= x) {
+            size_t len = (size_t)(gap_end - x + 1) * px_bytes;
+            memcpy(dst + off + (size_t)x * px_bytes, src + off + (size_t)x * px_bytes, len);
+            sync_bytes += len;
+        }
+        if (i < n && sx2[i] + 1 > x) x = sx2[i] + 1;
+    }
+}
+
+uint8_t* drm_display_begin_frame(const drm_rect_t* areas, int count) {
+    if (drm_fd < 0 || count < 1) return NULL;
+
+    uint64_t wait_start = 0;
+    SDL_LockMutex(lock);
+    int b;
+    while ((b = find_free()) < 0) {
+        // Double buffering with a flip in flight: wait for the vblank
+        SDL_UnlockMutex(lock);
+        if (!wait_start) {
+            wait_start = mono_time_us();
+            render_waits++;
+        }
+        SDL_SemWaitTimeout(flip_sem, 100);
+        SDL_LockMutex(lock);
+    }
+    // Newest complete frame; nobody draws into it while we copy
+    int src = ready >= 0 ? ready : (queued >= 0 ? queued : front);
+    SDL_UnlockMutex(lock);
+    if (wait_start) render_wait_us += mono_time_us() - wait_start;
+
+    // Bounding box of the areas, on the screen
+    int x1 = areas[0].x1, y1 = areas[0].y1, x2 = areas[0].x2, y2 = areas[0].y2;
+    for (int i = 1; i < count; i++) {
+        if (areas[i].x1 < x1) x1 = areas[i].x1;
+        if (areas[i].y1 < y1) y1 = areas[i].y1;
+        if (areas[i].x2 > x2) x2 = areas[i].x2;
+        if (areas[i].y2 > y2) y2 = areas[i].y2;
+    }
+    if (x1 < 0) x1 = 0;
+    if (y1 < 0) y1 = 0;
+    if (x2 >= mode_w) x2 = mode_w - 1;
+    if (y2 >= mode_h) y2 = mode_h - 1;
+
+    // Bring the back buffer up to date outside the areas about to be drawn.
+    // Their bounding box is not enough: LVGL redraws only the areas.
+    drm_buffer_t* bb = &bufs[b];
+    if (bb->damaged) {
+        for (int y = bb->dy1; y <= bb->dy2; y++)
+            sync_row(bb->map, bufs[src].map, y, bb->dx1, bb->dx2, areas, count);
+    }
+    bb->damaged = false;
+
+    for (int i = 0; i < num_bufs; i++) {
+        if (i == b) continue;
+        drm_buffer_t* o = &bufs[i];
+        if (!o->damaged) {
+            o->damaged = true;
+            o->dx1 = x1; o->dy1 = y1; o->dx2 = x2; o->dy2 = y2;
+        } else {
+            if (x1 < o->dx1) o->dx1 = x1;
+            if (y1 < o->dy1) o->dy1 = y1;
+            if (x2 > o->dx2) o->dx2 = x2;
+            if (y2 > o->dy2) o->dy2 = y2;
+        }
+    }
+
+    back = b;
+    return bb->map;
+}
+
+void drm_display_end_frame(uint64_t data_rx_us) {
+    if (drm_fd < 0 || back < 0) return;
+    uint64_t now = mono_time_us();
+
+    SDL_LockMutex(lock);
+    frames_ended++;
+    if (queued < 0) {
+        submit_flip(back, now, data_rx_us);
+    } else {
+        if (ready >= 0) {
+            // Never shown; its data is in this frame, so keep its receive time
+            frames_replaced++;
+            if (ready_rx_us && (!data_rx_us || ready_rx_us < data_rx_us)) data_rx_us = ready_rx_us;
+        }
+        ready = back;
+        ready_end_us = now;
+        ready_rx_us = data_rx_us;
+    }
+    back = -1;
+    SDL_UnlockMutex(lock);
+}
+
+void drm_display_print_stats(void) {
+    if (drm_fd < 0) return;
+    double secs = (double)(mono_time_us() - start_us) / 1e6;
+    if (secs <= 0.0) secs = 1e-6;
+
+    SDL_LockMutex(lock);
+    printf("DRM: %llu frames, %llu flips (%.1f/s), %llu replaced before scanout, %llu flip errors\n",
+           (unsigned long long)frames_ended, (unsigned long long)flips, (double)flips / secs,
+           (unsigned long long)frames_replaced, (unsigned long long)flip_errors);
+    printf("DRM: waited for a free buffer %llu times, %.1f ms total; %.1f KiB per frame copied to sync back buffers\n",
+           (unsigned long long)render_waits, (double)render_wait_us / 1000.0,
+           frames_ended ? (double)sync_bytes / 1024.0 / (double)frames_ended : 0.0);
+    histogram_print(&end_to_scanout, "DRM: ", "frame complete to scanout", 1000.0, "ms");
+    histogram_print(&rx_to_scanout, "DRM: ", "CAN frame to scanout latency", 1000.0, "ms");
+    histogram_print(&flip_interval, "DRM: ", "flip interval", 1000.0, "ms");
+    SDL_UnlockMutex(lock);
+}
+
+void drm_display_close(void) {
+    if (flip_thread) {
+        atomic_store(&flip_thread_stop, true);
+        SDL_WaitThread(flip_thread, NULL);
+        flip_thread = NULL;
+    }
+    if (drm_fd >= 0 && saved_crtc_valid) {
+        // Put back whatever was on screen before (console)
+        bool on = saved_crtc.mode_valid && saved_crtc.fb_id;
+        saved_crtc.set_connectors_ptr = on ? (uint64_t)(uintptr_t)&connector_id : 0;
+        saved_crtc.count_connectors = on ? 1 : 0;
+        ioctl(drm_fd, DRM_IOCTL_MODE_SETCRTC, &saved_crtc);
+        saved_crtc_valid = false;
+    }
+    for (int i = 0; i < num_bufs; i++) {
+        drm_buffer_t* b = &bufs[i];
+        if (b->map) munmap(b->map, (size_t)b->size);
+        if (b->fb_id) ioctl(drm_fd, DRM_IOCTL_MODE_RMFB, &b->fb_id);
+        if (b->handle) {
+            struct drm_mode_destroy_dumb destroy = { .handle = b->handle };
+            ioctl(drm_fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+        }
+        memset(b, 0, sizeof(*b));
+    }
+    num_bufs = 0;
+    if (flip_sem) {
+        SDL_DestroySemaphore(flip_sem);
+        flip_sem = NULL;
+    }
+    if (lock) {
+        SDL_DestroyMutex(lock);
+        lock = NULL;
+    }
+    if (drm_fd >= 0) {
+        close(drm_fd);
+        drm_fd = -1;
+    }
+}
+
+#else // --- WINDOWS SIMULATION ---
+
+bool drm_display_init(const char* card, int width, int height, int num_buffers, int bpp) {
+    (void)card; (void)width; (void)height; (void)num_buffers; (void)bpp;
+    printf("DRM: Only available on Linux.\n");
+    return false;
+}
+
+int drm_display_width(void) { return 0; }
+int drm_display_height(void) { return 0; }
+void drm_display_set_notify_event(uint32_t sdl_event_type) { (void)sdl_event_type; }
+bool drm_display_can_render(void) { return false; }
+
+uint8_t* drm_display_begin_frame(const drm_rect_t* areas, int count) {
+    (void)areas; (void)count;
+    return NULL;
+}
+
+void drm_display_end_frame(uint64_t data_rx_us) { (void)data_rx_us; }
+void drm_display_print_stats(void) {}
+void drm_display_close(void) {}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef DRM_DISPLAY_H
+#define DRM_DISPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Direct DRM/KMS output (--display drm): XRGB8888 or RGB565 dumb buffers
+// scanned out by page flips, no SDL renderer in between. LVGL draws straight
+// into the back buffer. Linux only; works on the Pi (vc4) and on vkms for
+// testing.
+
+#define DRM_DISPLAY_MAX_BUFFERS 3
+
+// Open the card, take the first connected connector and set a mode of
+// width x height if it has one, its preferred mode otherwise. Allocates
+// num_buffers (2 or 3) buffers of bpp 32 (XRGB8888) or 16 (RGB565) and
+// shows the first one, cleared.
+bool drm_display_init(const char* card, int width, int height, int num_buffers, int bpp);
+
+// Resolution of the mode that was set
+int drm_display_width(void);
+int drm_display_height(void);
+
+// Push an SDL event of this type after every completed flip, so the render
+// loop can wake up when a buffer frees. Call after drm_display_init.
+void drm_display_set_notify_event(uint32_t sdl_event_type);
+
+// True when a buffer is free to render into (neither on screen nor queued)
+bool drm_display_can_render(void);
+
+// Inclusive pixel rectangle
+typedef struct {
+    int x1, y1, x2, y2;
+} drm_rect_t;
+
+// Start a frame that redraws the given areas, each at least in full. Returns
+// the back buffer (pitch = width * bpp / 8); every pixel outside the areas
+// already holds the previous frame. Waits for a flip if no buffer is free.
+uint8_t* drm_display_begin_frame(const drm_rect_t* areas, int count);
+
+// The frame is complete: flip to it at the next vblank, or as soon as the
+// flip in flight has landed. A complete frame still waiting for that is
+// replaced by the newer one. data_rx_us is the receive time of the newest
+// CAN data in the frame (0 = none) for the latency statistics.
+void drm_display_end_frame(uint64_t data_rx_us);
+
+void drm_display_print_stats(void);
+
+// Restores the previous CRTC configuration
+void drm_display_close(void);
+
+#endif // DRM_DISPLAY_H
@@ -1,58 +1,229 @@
 #include "led_logic.h"
-#include "../lv_conf.h" 
-#include "lvgl.h" // For lv_tick_get
-
-void calculate_shift_lights(int rpm, led_color_t* leds) {
-    // Logic:
-    // 0-4000: Off
-    // 4000-6000: Green (LEDs 0-3)
-    // 6000-7000: White (LEDs 4-5)
-    // 7000-8000: Red   (LEDs 6-7)
-    // >8000: Blink All White/Red
-
-    // Clear all first
-    for(int i=0; i<8; i++) {
-        leds[i].r = 0; leds[i].g = 0; leds[i].b = 0;
-    }
-
-    if (rpm >= 8000) {
-        // Redline Blink
-        bool blink = (lv_tick_get() % 150 < 75); // Fast blink
-        for(int i=0; i<8; i++) {
-            if (blink) {
-                // White
-                leds[i].r = 255; leds[i].g = 255; leds[i].b = 255;
-            } else {
-                // Red
-                leds[i].r = 255; leds[i].g = 0;   leds[i].b = 0;
+#include "../util/mono_time.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SHIFT_LIGHT_MAX_RPM 20000
+
+// --- PROFILE (as written in the file) ---
+typedef struct {
+    int redline;
+    int gear_redline[SHIFT_LIGHT_MAX_GEAR + 1];     // 0 = base redline
+    int cold_below[SHIFT_LIGHT_MAX_COLD];           // Ascending coolant temperatures
+    int cold_redline[SHIFT_LIGHT_MAX_COLD];
+    int cold_count;
+    int led_offset[SHIFT_LIGHT_LEDS];               // On from redline + offset
+    led_color_t led_color[SHIFT_LIGHT_LEDS];
+    int blink_ms;
+    led_color_t blink_on;
+    led_color_t blink_off;
+    int bucket_rpm;
+} shift_profile_t;
+
+// 0-4000: Off, 4000-6000: Green (LEDs 0-3, dimmed slightly to not blind
+// the driver), 6000-7000: White (LEDs 4-5), 7000-8000: Red (LEDs 6-7),
+// one more LED every 500 rpm, >8000: Blink All White/Red
+static const shift_profile_t default_profile = {
+    .redline = 8000,
+    .led_offset = { -4000, -3500, -3000, -2500, -2000, -1500, -1000, -500 },
+    .led_color = {
+        { 0, 100, 0 }, { 0, 100, 0 }, { 0, 100, 0 }, { 0, 100, 0 },
+        { 100, 100, 100 }, { 100, 100, 100 },
+        { 200, 0, 0 }, { 200, 0, 0 },
+    },
+    .blink_ms = 150,
+    .blink_on = { 255, 255, 255 },
+    .blink_off = { 255, 0, 0 },
+    .bucket_rpm = 25,
+};
+
+// --- COMPILED TABLES ---
+typedef led_color_t shift_frame_t[SHIFT_LIGHT_LEDS];
+
+static shift_frame_t* frames = NULL;    // table_count x (bucket_count + 1); the last one is blink off
+static int bucket_rpm = 1;
+static int bucket_count = 0;
+static int blink_bucket[(SHIFT_LIGHT_MAX_GEAR + 1) * (SHIFT_LIGHT_MAX_COLD + 1)];
+static int table_redline[(SHIFT_LIGHT_MAX_GEAR + 1) * (SHIFT_LIGHT_MAX_COLD + 1)];
+static uint8_t table_of[SHIFT_LIGHT_MAX_GEAR + 1][SHIFT_LIGHT_MAX_COLD + 1];
+static int cold_below[SHIFT_LIGHT_MAX_COLD];
+static int cold_count = 0;
+static uint64_t blink_period_us = 1;
+static bool compiled = false;
+
+static int gear_cold_redline(const shift_profile_t* p, int gear, int cold) {
+    int redline = p->gear_redline[gear] ? p->gear_redline[gear] : p->redline;
+    if (cold < p->cold_count && p->cold_redline[cold] < redline) redline = p->cold_redline[cold];
+    return redline;
+}
+
+static bool compile_profile(const shift_profile_t* p) {
+    // One table per distinct redline
+    int redlines[(SHIFT_LIGHT_MAX_GEAR + 1) * (SHIFT_LIGHT_MAX_COLD + 1)];
+    int tables = 0, max_redline = 0;
+    uint8_t index[SHIFT_LIGHT_MAX_GEAR + 1][SHIFT_LIGHT_MAX_COLD + 1];
+    for (int g = 0; g <= SHIFT_LIGHT_MAX_GEAR; g++) {
+        for (int c = 0; c <= p->cold_count; c++) {
+            int redline = gear_cold_redline(p, g, c);
+            int t = 0;
+            while (t < tables && redlines[t] != redline) t++;
+            if (t == tables) redlines[tables++] = redline;
+            index[g][c] = (uint8_t)t;
+            if (redline > max_redline) max_redline = redline;
+        }
+    }
+
+    // Buckets up to the first one past the highest redline; rpm above it clamps there
+    int buckets = max_redline / p->bucket_rpm + 2;
+    shift_frame_t* f = calloc((size_t)tables * (size_t)(buckets + 1), sizeof(shift_frame_t));
+    if (!f) {
+        perror("LED: Failed to allocate shift light tables");
+        return false;
+    }
+
+    for (int t = 0; t < tables; t++) {
+        shift_frame_t* table = f + (size_t)t * (size_t)(buckets + 1);
+        // Thresholds round up to the next bucket
+        blink_bucket[t] = (redlines[t] + p->bucket_rpm - 1) / p->bucket_rpm;
+        for (int b = 0; b < buckets; b++) {
+            int rpm = b * p->bucket_rpm;
+            for (int i = 0; i < SHIFT_LIGHT_LEDS; i++) {
+                if (b >= blink_bucket[t]) table[b][i] = p->blink_on;
+                else if (rpm >= redlines[t] + p->led_offset[i]) table[b][i] = p->led_color[i];
             }
         }
-        return;
+        for (int i = 0; i < SHIFT_LIGHT_LEDS; i++) table[buckets][i] = p->blink_off;
     }
 
-    // Normal progression
-    int leds_active = 0;
-    
-    // Calculate how many LEDs should be ON
-    if (rpm > 4000) leds_active = 1;
-    if (rpm > 4500) leds_active = 2;
-    if (rpm > 5000) leds_active = 3;
-    if (rpm > 5500) leds_active = 4;
-    if (rpm > 6000) leds_active = 5;
-    if (rpm > 6500) leds_active = 6;
-    if (rpm > 7000) leds_active = 7;
-    if (rpm > 7500) leds_active = 8;
-
-    for (int i=0; i < leds_active; i++) {
-        if (i < 4) {
-            // Green (Dimmed slightly to not blind driver)
-            leds[i].r = 0; leds[i].g = 100; leds[i].b = 0;
-        } else if (i < 6) {
-            // White
-            leds[i].r = 100; leds[i].g = 100; leds[i].b = 100;
-        } else {
-            // Red
-            leds[i].r = 200; leds[i].g = 0;   leds[i].b = 0;
+    free(frames);
+    frames = f;
+    memcpy(table_redline, redlines, (size_t)tables * sizeof(int));
+    bucket_rpm = p->bucket_rpm;
+    bucket_count = buckets;
+    memcpy(table_of, index, sizeof(table_of));
+    memcpy(cold_below, p->cold_below, sizeof(cold_below));
+    cold_count = p->cold_count;
+    blink_period_us = (uint64_t)p->blink_ms * 1000u;
+    compiled = true;
+    printf("LED: Shift lights: %d table%s of %d buckets (%d rpm), %zu KiB\n", tables, tables > 1 ? "s" : "",
+           buckets, bucket_rpm, (size_t)tables * (size_t)(buckets + 1) * sizeof(shift_frame_t) / 1024);
+    return true;
+}
+
+// --- PROFILE FILE ---
+static bool parse_color(const char* s, led_color_t* c) {
+    unsigned r, g, b;
+    if (sscanf(s, "%u,%u,%u", &r, &g, &b) != 3 || r > 255 || g > 255 || b > 255) return false;
+    c->r = (uint8_t)r;
+    c->g = (uint8_t)g;
+    c->b = (uint8_t)b;
+    return true;
+}
+
+static bool valid_rpm(int rpm) {
+    return rpm > 0 && rpm <= SHIFT_LIGHT_MAX_RPM;
+}
+
+static bool parse_line(char* p, shift_profile_t* prof) {
+    char key[16], a[32], b[32], c[32];
+    int n = sscanf(p, "%15s %31s %31s %31s", key, a, b, c);
+    if (n < 1) return true;
+
+    if (strcmp(key, "redline") == 0 && n == 2) {
+        prof->redline = atoi(a);
+        return valid_rpm(prof->redline);
+    }
+    if (strcmp(key, "gear") == 0 && n == 3) {
+        int gear = atoi(a);
+        if (gear < 1 || gear > SHIFT_LIGHT_MAX_GEAR) return false;
+        prof->gear_redline[gear] = atoi(b);
+        return valid_rpm(prof->gear_redline[gear]);
+    }
+    if (strcmp(key, "cold") == 0 && n == 3) {
+        int below = atoi(a);
+        if (prof->cold_count == SHIFT_LIGHT_MAX_COLD) return false;
+        if (prof->cold_count && below <= prof->cold_below[prof->cold_count - 1]) return false;
+        prof->cold_below[prof->cold_count] = below;
+        prof->cold_redline[prof->cold_count] = atoi(b);
+        return valid_rpm(prof->cold_redline[prof->cold_count++]);
+    }
+    if (strcmp(key, "led") == 0 && n == 4) {
+        int i = atoi(a);
+        if (i < 0 || i >= SHIFT_LIGHT_LEDS) return false;
+        prof->led_offset[i] = atoi(b);
+        return prof->led_offset[i] <= 0 && parse_color(c, &prof->led_color[i]);
+    }
+    if (strcmp(key, "blink") == 0 && n == 4) {
+        prof->blink_ms = atoi(a);
+        return prof->blink_ms >= 2 && parse_color(b, &prof->blink_on) && parse_color(c, &prof->blink_off);
+    }
+    if (strcmp(key, "bucket") == 0 && n == 2) {
+        prof->bucket_rpm = atoi(a);
+        return prof->bucket_rpm >= 1 && prof->bucket_rpm <= 500;
+    }
+    return false;
+}
+
+bool shift_lights_load(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror("LED: open shift light profile");
+        return false;
+    }
+
+    // Unset LEDs stay off, everything else starts from the default
+    shift_profile_t prof = default_profile;
+    for (int i = 0; i < SHIFT_LIGHT_LEDS; i++) {
+        prof.led_offset[i] = -SHIFT_LIGHT_MAX_RPM - 1;
+        memset(&prof.led_color[i], 0, sizeof(led_color_t));
+    }
+
+    char line[256];
+    int line_no = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f)) {
+        line_no++;
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        if (!parse_line(line, &prof)) {
+            printf("LED: %s:%d: bad line\n", path, line_no);
+            ok = false;
         }
     }
+    fclose(f);
+
+    if (!ok || !compile_profile(&prof)) return false;
+    printf("LED: Shift light profile %s: redline %d, %d cold step%s\n", path, prof.redline,
+           prof.cold_count, prof.cold_count == 1 ? "" : "s");
+    return true;
+}
+
+// --- PER FRAME ---
+static int find_table(int gear, int clt) {
+    if (gear < 0 || gear > SHIFT_LIGHT_MAX_GEAR) gear = 0;
+    int cold = 0;
+    while (cold < cold_count && clt >= cold_below[cold]) cold++;
+    return table_of[gear][cold];
+}
+
+int shift_lights_redline(int gear, int clt) {
+    if (!compiled && !compile_profile(&default_profile)) return default_profile.redline;
+    return table_redline[find_table(gear, clt)];
+}
+
+void calculate_shift_lights(int rpm, int gear, int clt, led_color_t* leds) {
+    if (!compiled && !compile_profile(&default_profile)) {
+        memset(leds, 0, sizeof(shift_frame_t));
+        return;
+    }
+
+    int t = find_table(gear, clt);
+
+    int b = rpm > 0 ? rpm / bucket_rpm : 0;
+    if (b >= bucket_count) b = bucket_count - 1;
+    // Redline Blink. Runs on the LED thread: the monotonic clock, not the LVGL tick
+    if (b >= blink_bucket[t] && mono_time_us() % blink_period_us >= blink_period_us / 2) b = bucket_count;
+
+    memcpy(leds, frames[(size_t)t * (size_t)(bucket_count + 1) + (size_t)b], sizeof(shift_frame_t));
 }
@@ -1,9 +1,28 @@
 #ifndef LED_LOGIC_H
 #define LED_LOGIC_H
 
+#include <stdbool.h>
 #include "ws2812_driver.h"
 
-// Calculate colors for the 8 LEDs based on RPM
-void calculate_shift_lights(int rpm, led_color_t* leds);
+// Shift light profiles (see shiftlights/example.txt) are compiled at load
+// time into one table per distinct redline: a frame of SHIFT_LIGHT_LEDS
+// colours for every rpm bucket. Which table applies depends on the gear
+// and the coolant temperature; the frame is then one index and a copy.
+
+#define SHIFT_LIGHT_LEDS 8
+#define SHIFT_LIGHT_MAX_GEAR 8          // Gears 1..8 can have their own redline
+#define SHIFT_LIGHT_MAX_COLD 4          // Coolant temperature steps
+#define SHIFT_LIGHT_CLT_UNKNOWN 10000   // No coolant reading: no cold limit
+
+// Parse and compile a profile. Returns false (and prints why) on I/O or
+// syntax errors and keeps the profile in use. Without one the built-in
+// default is used. Call before the LED thread starts.
+bool shift_lights_load(const char* path);
+
+// Redline in effect for this gear and coolant temperature
+int shift_lights_redline(int gear, int clt);
+
+// Colors for the 8 LEDs. gear 0 (or out of range) uses the base redline.
+void calculate_shift_lights(int rpm, int gear, int clt, led_color_t* leds);
 
 #endif
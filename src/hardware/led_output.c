@@ -0,0 +1,102 @@
+#include "led_output.h"
+#include "../util/mono_time.h"
+#include "../util/histogram.h"
+#include "../util/frame_sched.h"
+#include <SDL.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+static SDL_Thread* thread = NULL;
+static atomic_bool stop = false;
+static int led_count = 0;
+static led_frame_fn frame_source = NULL;
+static int rate_hz = 0;
+static uint64_t keepalive_us = 0;
+
+// Double buffer: front = last frame on the wire, back = the one being built
+static led_color_t frames[2][LED_OUTPUT_MAX_LEDS];
+static int front = 0;
+
+// Written by the LED thread, read after it has stopped
+static frame_sched_t sched;
+static histogram_t tx_time;          // ws2812_update per sent frame (us)
+static uint64_t sent = 0;
+static uint64_t keepalives = 0;      // Sent unchanged because the keep-alive was due
+static uint64_t skipped = 0;         // Unchanged, not sent
+static uint64_t failed = 0;          // A strip may show part of it; sent again next frame
+
+static int led_thread_entry(void* data) {
+    (void)data;
+    uint64_t last_sent_us = 0;
+    bool have_front = false;
+
+    frame_sched_init(&sched, rate_hz);
+    while (!atomic_load(&stop)) {
+        frame_sched_wait(&sched);
+
+        int back = front ^ 1;
+        frame_source(frames[back], led_count);
+
+        uint64_t now = mono_time_us();
+        bool changed = !have_front || memcmp(frames[back], frames[front], sizeof(led_color_t) * (size_t)led_count) != 0;
+        bool keepalive = keepalive_us && now - last_sent_us >= keepalive_us;
+        if (!changed && !keepalive) {
+            skipped++;
+            continue;
+        }
+
+        bool ok = ws2812_update(frames[back]);
+        uint64_t done = mono_time_us();
+        histogram_add(&tx_time, done - now);
+        sent++;
+        if (!changed) keepalives++;
+        last_sent_us = done;
+        front = back;
+        // Not on the wire as built: counts as changed until it goes out
+        have_front = ok;
+        if (!ok) failed++;
+    }
+    return 0;
+}
+
+bool led_output_start(int num_leds, led_frame_fn source, int hz, int keepalive_ms) {
+    if (num_leds < 1 || num_leds > LED_OUTPUT_MAX_LEDS || !source) return false;
+    led_count = num_leds;
+    frame_source = source;
+    rate_hz = hz < 1 ? 1 : hz;
+    keepalive_us = keepalive_ms > 0 ? (uint64_t)keepalive_ms * 1000u : 0;
+    histogram_reset(&tx_time);
+    atomic_store(&stop, false);
+
+    thread = SDL_CreateThread(led_thread_entry, "LEDThread", NULL);
+    if (!thread) {
+        printf("LED: Failed to start output thread (%s).\n", SDL_GetError());
+        return false;
+    }
+    printf("LED: Output thread at %d Hz, keep-alive %d ms.\n", rate_hz, keepalive_ms);
+    return true;
+}
+
+void led_output_stop(void) {
+    if (!thread) return;
+    atomic_store(&stop, true);
+    SDL_WaitThread(thread, NULL);
+    thread = NULL;
+
+    led_color_t off[LED_OUTPUT_MAX_LEDS];
+    memset(off, 0, sizeof(off));
+    ws2812_update(off);
+}
+
+void led_output_print_stats(void) {
+    if (!sched.frames) return;
+    uint64_t unchanged_pct = skipped * 100u / sched.frames;
+    printf("LED: %llu frames at %d Hz, %llu sent (%llu keep-alive, %llu failed), %llu unchanged and skipped (%llu%%), "
+           "%llu deadlines missed\n",
+           (unsigned long long)sched.frames, rate_hz, (unsigned long long)sent, (unsigned long long)keepalives,
+           (unsigned long long)failed, (unsigned long long)skipped, (unsigned long long)unchanged_pct,
+           (unsigned long long)sched.missed);
+    histogram_print(&tx_time, "LED: ", "SPI transmit time", 1.0, "us");
+    histogram_print(&sched.jitter, "LED: ", "frame interval jitter", 1.0, "us");
+}
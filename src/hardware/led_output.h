@@ -0,0 +1,28 @@
+#ifndef LED_OUTPUT_H
+#define LED_OUTPUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ws2812_driver.h"
+
+// Shift light output on its own thread, at its own fixed rate, so the
+// blocking SPI transfer never stalls the render loop. Every tick the frame
+// source fills the back buffer; it is sent (and becomes the front buffer)
+// only if it differs from the last frame sent, or when the keep-alive
+// interval has passed since then.
+
+#define LED_OUTPUT_MAX_LEDS 1024
+
+// Fills num_leds colours for the current moment. Runs on the LED thread.
+typedef void (*led_frame_fn)(led_color_t* out, int num_leds);
+
+// ws2812_init must have succeeded (or be the simulation driver).
+// keepalive_ms 0 = only send on change.
+bool led_output_start(int num_leds, led_frame_fn source, int hz, int keepalive_ms);
+
+// Stop the thread and switch the LEDs off
+void led_output_stop(void);
+
+void led_output_print_stats(void);
+
+#endif // LED_OUTPUT_H
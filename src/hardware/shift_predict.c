@@ -0,0 +1,166 @@
+#include "shift_predict.h"
+#include "../can/can_history.h"
+#include "../util/histogram.h"
+#include <stdio.h>
+#include <string.h>
+
+#define RING_SIZE 64    // Recent samples kept for the fit (power of two)
+
+static bool enabled = false;
+static int lead_us = 0;
+static bool log_crossings = false;
+
+static can_history_cursor_t cursor;
+static can_history_sample_t ring[RING_SIZE];
+static uint64_t ring_count = 0;
+
+// --- CROSSING TRACKER ---
+static bool armed = true;           // Below redline - rearm since the last crossing
+static bool lit = false;            // Lights at redline, crossing not seen yet
+static uint64_t lit_us = 0;
+static uint64_t predicted_us = 0;   // When the fit said the redline would be reached (0 = no fit)
+static int crossing_redline = 0;
+
+static uint64_t crossings = 0;
+static uint64_t crossings_late = 0;     // Lights came on after the crossing
+static uint64_t predicted_early = 0;    // Prediction before the actual crossing
+static uint64_t predicted_late = 0;
+static uint64_t false_alarms = 0;       // Lit, then the rpm fell back without crossing
+static histogram_t lead_time;           // Crossing - lights on, crossings lit in time (us)
+static histogram_t late_time;           // Lights on - crossing, the others (us)
+static histogram_t predict_error;       // |crossing - predicted| (us)
+
+void shift_predict_init(int lead_ms, bool log) {
+    enabled = lead_ms > 0 || log;
+    lead_us = lead_ms > 0 ? lead_ms * 1000 : 0;
+    log_crossings = log;
+    histogram_reset(&lead_time);
+    histogram_reset(&late_time);
+    histogram_reset(&predict_error);
+    if (enabled && can_history_capacity() == 0)
+        printf("Warning: shift light prediction needs the channel history (--history-kb).\n");
+    else if (lead_us)
+        printf("LED: Predictive shift lights, %d ms lead, slope over %d ms\n", lead_ms, SHIFT_PREDICT_WINDOW_MS);
+}
+
+bool shift_predict_enabled(void) {
+    return enabled;
+}
+
+// The newest sample crossed the redline; seen_us is when this thread got it
+static void track_crossing(const can_history_sample_t* prev, const can_history_sample_t* cur, uint64_t seen_us) {
+    // Interpolated between the samples either side
+    double f = (crossing_redline - prev->value) / (double)(cur->value - prev->value);
+    uint64_t actual_us = prev->stamp_us + (uint64_t)(f * (double)(cur->stamp_us - prev->stamp_us));
+
+    // Not lit ahead: the lights came on with this sample
+    if (!lit) lit_us = seen_us > cur->stamp_us ? seen_us : cur->stamp_us;
+    crossings++;
+    if (lit_us <= actual_us) {
+        histogram_add(&lead_time, actual_us - lit_us);
+    } else {
+        crossings_late++;
+        histogram_add(&late_time, lit_us - actual_us);
+    }
+
+    if (predicted_us) {
+        if (predicted_us <= actual_us) predicted_early++;
+        else predicted_late++;
+        histogram_add(&predict_error, predicted_us > actual_us ? predicted_us - actual_us : actual_us - predicted_us);
+    }
+    if (log_crossings) {
+        double lights_ms = ((double)lit_us - (double)actual_us) / 1000.0;
+        printf("LED: redline %d crossed at %.3f s, lights %.1f ms %s", crossing_redline, (double)actual_us / 1e6,
+               lights_ms < 0 ? -lights_ms : lights_ms, lights_ms < 0 ? "before" : "after");
+        if (predicted_us) {
+            double pred_ms = ((double)predicted_us - (double)actual_us) / 1000.0;
+            printf(", predicted %.1f ms %s", pred_ms < 0 ? -pred_ms : pred_ms, pred_ms < 0 ? "early" : "late");
+        }
+        printf("\n");
+    }
+    armed = false;
+    lit = false;
+    predicted_us = 0;
+}
+
+static void take_sample(const can_history_sample_t* s, uint64_t now_us) {
+    const can_history_sample_t* prev = ring_count ? &ring[(ring_count - 1) & (RING_SIZE - 1)] : NULL;
+    if (crossing_redline > 0) {
+        if (armed && prev && prev->value < crossing_redline && s->value >= crossing_redline) {
+            track_crossing(prev, s, now_us);
+        } else if (s->value < crossing_redline - SHIFT_PREDICT_REARM_RPM) {
+            if (lit) false_alarms++;
+            armed = true;
+            lit = false;
+            predicted_us = 0;
+        }
+    }
+    ring[ring_count++ & (RING_SIZE - 1)] = *s;
+}
+
+// Least squares over the samples of the last window. False if too few.
+static bool fit_slope(double* slope_per_us) {
+    if (ring_count < 3) return false;
+    const can_history_sample_t* last = &ring[(ring_count - 1) & (RING_SIZE - 1)];
+    uint64_t n_max = ring_count < RING_SIZE ? ring_count : RING_SIZE;
+
+    double st = 0, sv = 0, stt = 0, stv = 0;
+    int n = 0;
+    for (uint64_t i = 0; i < n_max; i++) {
+        const can_history_sample_t* s = &ring[(ring_count - 1 - i) & (RING_SIZE - 1)];
+        if (last->stamp_us - s->stamp_us > SHIFT_PREDICT_WINDOW_MS * 1000u) break;
+        double t = -(double)(last->stamp_us - s->stamp_us);
+        st += t;
+        sv += s->value;
+        stt += t * t;
+        stv += t * s->value;
+        n++;
+    }
+    double den = n * stt - st * st;
+    if (n < 3 || den <= 0.0) return false;
+    *slope_per_us = (n * stv - st * sv) / den;
+    return true;
+}
+
+int shift_predict_rpm(int rpm, int redline, uint64_t now_us) {
+    if (!enabled) return rpm;
+    crossing_redline = redline;
+
+    can_history_sample_t batch[RING_SIZE];
+    int n;
+    do {
+        n = can_history_read(CAN_CH_RPM, &cursor, batch, RING_SIZE);
+        for (int i = 0; i < n; i++) take_sample(&batch[i], now_us);
+    } while (n == RING_SIZE);
+    if (ring_count == 0) return rpm;
+
+    const can_history_sample_t* last = &ring[(ring_count - 1) & (RING_SIZE - 1)];
+    uint64_t age_us = now_us > last->stamp_us ? now_us - last->stamp_us : 0;
+    int shown = (int)last->value;
+    double slope;
+    bool fit = lead_us && age_us <= SHIFT_PREDICT_MAX_AGE_MS * 1000u && fit_slope(&slope) && slope > 0.0;
+    if (fit) {
+        // From the newest sample to now, plus the lead
+        shown = (int)(last->value + slope * (double)(age_us + (uint64_t)lead_us));
+    }
+
+    if (armed && !lit && shown >= redline && last->value < redline) {
+        lit = true;
+        lit_us = now_us;
+        predicted_us = fit ? last->stamp_us + (uint64_t)((redline - last->value) / slope) : 0;
+    }
+    return shown;
+}
+
+void shift_predict_print_stats(void) {
+    if (!enabled) return;
+    printf("LED: %llu redline crossings, %llu lit late, %llu false alarms\n", (unsigned long long)crossings,
+           (unsigned long long)crossings_late, (unsigned long long)false_alarms);
+    if (lead_time.count) histogram_print(&lead_time, "LED: ", "lights before the crossing", 1000.0, "ms");
+    if (late_time.count) histogram_print(&late_time, "LED: ", "lights after the crossing", 1000.0, "ms");
+    if (predict_error.count) {
+        printf("LED: predicted crossing early %llu, late %llu\n", (unsigned long long)predicted_early,
+               (unsigned long long)predicted_late);
+        histogram_print(&predict_error, "LED: ", "prediction error", 1000.0, "ms");
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef SHIFT_PREDICT_H
+#define SHIFT_PREDICT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Predictive shift lights. The rpm the LED thread sees was received some ms
+// ago and the LEDs, and the driver, take more time still, so at 1000+ rpm/s
+// in the low gears they come on late. The rpm slope is fitted over the last
+// SHIFT_PREDICT_WINDOW_MS of samples from the history ring, and the lights
+// are driven by the rpm extrapolated to now + lead time: each threshold
+// lights lead_ms before the rpm is predicted to reach it. Only a climbing
+// rpm is extrapolated.
+//
+// Every crossing of the redline is also tracked: when the lights came on,
+// when the prediction said the rpm would get there, and when the received
+// samples actually did (interpolated between the two either side).
+
+#define SHIFT_PREDICT_WINDOW_MS   100
+#define SHIFT_PREDICT_MAX_AGE_MS  250   // Older newest sample: no extrapolation
+#define SHIFT_PREDICT_REARM_RPM   300   // Below redline by this much: next crossing
+
+// lead_ms 0 = show the received rpm (crossings are still tracked).
+// log_crossings prints one line per crossing. Needs the history rings
+// (can_history_init); call before the LED thread starts.
+void shift_predict_init(int lead_ms, bool log_crossings);
+
+bool shift_predict_enabled(void);
+
+// LED thread: take the new rpm samples and return the rpm to show now.
+// rpm (the snapshot value) is returned when there is nothing to go on.
+int shift_predict_rpm(int rpm, int redline, uint64_t now_us);
+
+void shift_predict_print_stats(void);
+
+#endif // SHIFT_PREDICT_H
@@ -5,159 +5,292 @@
 
 static int led_count = 0;
 
+bool ws2812_init(int num_leds) {
+    ws2812_strip_t strip = { "/dev/spidev0.0", num_leds };
+    return ws2812_init_strips(&strip, 1);
+}
+
+int ws2812_led_count(void) {
+    return led_count;
+}
+
 #ifdef __linux__
 #include <fcntl.h>
 #include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 #include <sys/ioctl.h>
 #include <linux/spi/spidev.h>
-
-static int spi_fd = -1;
-static uint8_t* spi_buffer = NULL;
-static int spi_buffer_len = 0;
+#include <SDL.h>
+#include "ws2812_encode.h"
+#include "../util/mono_time.h"
+#include "../util/histogram.h"
 
 // SPI Configuration
-static const char *device = "/dev/spidev0.0";
-static uint32_t mode = 0;
+static uint8_t mode = 0;
 static uint8_t bits = 8;
-static uint32_t speed = 2400000; // 2.4 MHz matches WS2812 timing with 3 bits per bit
-static uint16_t delay = 0;
+static uint32_t speed = WS2812_SPI_HZ; // 3 SPI bits per WS2812 bit, see ws2812_encode.h
 
-bool ws2812_init(int num_leds) {
-    led_count = num_leds;
-    
-    // Open SPI
-    spi_fd = open(device, O_RDWR);
-    if (spi_fd < 0) {
+#define SPIDEV_BUFSIZ_DEFAULT 4096
+#define SEND_TRIES            3     // Whole-strip attempts when a pause between chunks latched it
+#define RT_PRIORITY           50    // SCHED_FIFO for the threads that send strips
+
+typedef struct {
+    const char* device;
+    int fd;
+    int first_led;
+    int num_leds;
+    uint8_t* buf;               // Encoded data + reset
+    size_t len;
+    size_t chunk;               // Bytes per SPI message: spidev bufsiz, rounded down to whole LEDs
+    // Every strip is sent by its own real-time thread, so nothing else
+    // (the LED thread waits on the CAN seqlock) runs at that priority
+    SDL_Thread* thread;
+    SDL_sem* go;
+    SDL_sem* done;
+    bool ok;                    // Last update went out
+    int err;                    // errno of a failed transfer, 0 if the pauses were the problem
+    // Stats
+    uint64_t transfers;
+    uint64_t failures;
+    uint64_t resends;           // Restarted because a pause between chunks reached the reset
+    uint64_t max_gap_us;        // Longest pause between the chunks of one update
+} strip_t;
+
+static strip_t strips[WS2812_MAX_STRIPS];
+static int strip_count = 0;
+static atomic_bool stopping = false;
+static histogram_t update_time;     // Encode + all strips out (us)
+
+// spidev refuses messages larger than its bufsiz module parameter
+static size_t spidev_bufsiz(void) {
+    unsigned v = SPIDEV_BUFSIZ_DEFAULT;
+    FILE* f = fopen("/sys/module/spidev/parameters/bufsiz", "r");
+    if (f) {
+        if (fscanf(f, "%u", &v) != 1 || v == 0) v = SPIDEV_BUFSIZ_DEFAULT;
+        fclose(f);
+    }
+    return v;
+}
+
+// A busy CPU can hold a sender off between two chunks long enough to latch
+static bool set_realtime(void) {
+    static atomic_bool warned = false;
+    struct sched_param sp = { .sched_priority = RT_PRIORITY };
+    int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+    if (err == 0) return true;
+    if (!atomic_exchange(&warned, true))
+        printf("WS2812: Warning: no real-time priority (%s); run as root or grant CAP_SYS_NICE.\n", strerror(err));
+    return false;
+}
+
+// Chunks end between LEDs, where the line is low, so a short pause before the
+// next one only stretches a low phase. At the reset time the strip latches
+// what it has and takes the rest as a new frame: wait out a reset and send
+// the whole strip again. The pause is the time between the ends of two
+// transfers less the wire time of the second.
+static bool send_strip(strip_t* s) {
+    s->err = 0;
+    for (int attempt = 0; attempt < SEND_TRIES; attempt++) {
+        size_t off = 0;
+        uint64_t last_end = 0;
+        bool latched = false;
+        while (off < s->len && !latched) {
+            size_t n = s->len - off < s->chunk ? s->len - off : s->chunk;
+            struct spi_ioc_transfer tr;
+            memset(&tr, 0, sizeof(tr));
+            tr.tx_buf = (unsigned long)(s->buf + off);
+            tr.len = (uint32_t)n;
+            tr.speed_hz = speed;
+            tr.bits_per_word = bits;
+
+            if (ioctl(s->fd, SPI_IOC_MESSAGE(1), &tr) < 0) {
+                s->err = errno;
+                return false;
+            }
+            uint64_t end = mono_time_us();
+            if (last_end) {
+                uint64_t wire = (uint64_t)n * 8u * 1000000u / speed;
+                uint64_t gap = end - last_end > wire ? end - last_end - wire : 0;
+                if (gap > s->max_gap_us) s->max_gap_us = gap;
+                latched = gap >= WS2812_RESET_US;
+            }
+            last_end = end;
+            s->transfers++;
+            off += n;
+        }
+        if (!latched) return true;
+        s->resends++;
+        usleep(WS2812_RESET_BYTES * 8u * 1000000u / speed);
+    }
+    return false;
+}
+
+static int strip_thread_entry(void* data) {
+    strip_t* s = data;
+    set_realtime();
+    while (1) {
+        SDL_SemWait(s->go);
+        if (atomic_load(&stopping)) break;
+        s->ok = send_strip(s);
+        SDL_SemPost(s->done);
+    }
+    return 0;
+}
+
+static bool open_strip(strip_t* s, size_t bufsiz) {
+    s->fd = open(s->device, O_RDWR);
+    if (s->fd < 0) {
+        fprintf(stderr, "%s: ", s->device);
         perror("WS2812: Failed to open SPI device (Run raspi-config to enable SPI?)");
         return false;
     }
 
     // Setup SPI
-    if (ioctl(spi_fd, SPI_IOC_WR_MODE, &mode) == -1) return false;
-    if (ioctl(spi_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) == -1) return false;
-    if (ioctl(spi_fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) == -1) return false;
-
-    // Buffer allocation:
-    // Each LED has 24 bits (G,R,B).
-    // Each logical bit needs 3 SPI bits (to emulate timing).
-    // 24 * 3 = 72 bytes per LED.
-    // + Reset signal (roughly 50us of zeros). At 2.4MHz, 1 byte is ~3.3us. So ~20 bytes zero.
-    spi_buffer_len = (led_count * 72) + 64; 
-    spi_buffer = malloc(spi_buffer_len);
-    if (!spi_buffer) {
+    if (ioctl(s->fd, SPI_IOC_WR_MODE, &mode) == -1 ||
+        ioctl(s->fd, SPI_IOC_WR_BITS_PER_WORD, &bits) == -1 ||
+        ioctl(s->fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) == -1) {
+        perror("WS2812: Failed to configure SPI");
+        return false;
+    }
+
+    // 9 bytes per LED plus the reset
+    s->len = ws2812_encoded_size(s->num_leds);
+    s->buf = malloc(s->len);
+    if (!s->buf) {
         perror("WS2812: Failed to allocate SPI buffer");
-        close(spi_fd);
         return false;
     }
-    memset(spi_buffer, 0, spi_buffer_len); // Reset signal at end/start
+    s->chunk = bufsiz / WS2812_BYTES_PER_LED * WS2812_BYTES_PER_LED;
+    if (s->chunk == 0) {
+        printf("WS2812: spidev bufsiz %zu is less than one LED (%d bytes).\n", bufsiz, WS2812_BYTES_PER_LED);
+        return false;
+    }
 
-    printf("WS2812: Hardware initialized on %s\n", device);
+    size_t chunks = (s->len + s->chunk - 1) / s->chunk;
+    printf("WS2812: Hardware initialized on %s (%d LEDs, %zu bytes per update at %.1f MHz, %zu transfer%s)\n",
+           s->device, s->num_leds, s->len, speed / 1e6, chunks, chunks > 1 ? "s" : "");
+    if (chunks > 1)
+        printf("WS2812: Warning: %s is longer than spidev bufsiz (%zu); a %d us pause between its transfers "
+               "latches a partial frame, which is then sent again. spidev.bufsiz=%zu on the kernel command line "
+               "sends it in one.\n", s->device, bufsiz, WS2812_RESET_US, s->len);
     return true;
 }
 
-void ws2812_update(led_color_t* colors) {
-    if (spi_fd < 0 || !spi_buffer) return;
-
-    int buf_idx = 0;
-
-    for (int i = 0; i < led_count; i++) {
-        // WS2812 expects GRB order
-        uint32_t color = (colors[i].g << 16) | (colors[i].r << 8) | colors[i].b;
-
-        // Process 24 bits (MSB first)
-        for (int bit = 23; bit >= 0; bit--) {
-            if ((color >> bit) & 1) {
-                // '1' code: High, High, Low (110 binary = 0x6)
-                // Actually we map to bytes. 3 SPI bits = 1 data bit.
-                // It's easier to pack byte-by-byte.
-                // Let's use a byte for every 3 bits? No, 1 byte = 8 bits.
-                // 3 bits * 8 = 24 bits. So 1 byte of color = 3 bytes of SPI.
-                // Wait, logic check:
-                // 1 LED bit = 3 SPI bits.
-                // 1 Byte (8 LED bits) = 24 SPI bits = 3 Bytes SPI.
-                // Perfect.
-            }
+bool ws2812_init_strips(const ws2812_strip_t* cfg, int count) {
+    if (count < 1 || count > WS2812_MAX_STRIPS) return false;
+    size_t bufsiz = spidev_bufsiz();
+    atomic_store(&stopping, false);
+
+    led_count = 0;
+    strip_count = 0;
+    histogram_reset(&update_time);
+    for (int i = 0; i < count; i++) {
+        strip_t* s = &strips[i];
+        memset(s, 0, sizeof(*s));
+        s->device = cfg[i].device;
+        s->num_leds = cfg[i].num_leds > 0 ? cfg[i].num_leds : 1;
+        s->first_led = led_count;
+        strip_count++;
+        if (!open_strip(s, bufsiz)) {
+            ws2812_close();
+            return false;
         }
-        
-        // Simpler loop: Byte by Byte (G, R, B)
-        uint8_t bytes[3] = {colors[i].g, colors[i].r, colors[i].b};
-        
-        for (int b = 0; b < 3; b++) {
-            uint8_t val = bytes[b];
-            for (int bit = 7; bit >= 0; bit--) {
-                // SPI encoding for 2.4MHz:
-                // '0' = 100 (High 0.41us, Low 0.83us) -> 0b100xxxxx (Top 3 bits of byte? No)
-                // We need to construct the SPI stream bit by bit.
-                // This is complex to pack into bytes.
-                // Easier method: Use 6.4MHz? 
-                // Let's use the byte-expansion method.
-                // 1 LED Data Bit -> 1 SPI Byte (wasteful but easy).
-                // '0' = 0xC0 (11000000) at higher freq? 
-                // Standard 2.4MHz method:
-                // 1 data bit = 3 SPI bits.
-                // 8 data bits = 24 SPI bits = 3 SPI Bytes.
-                
-                // Let's pack 8 data bits into 3 SPI bytes.
-                // Bit 7 (MSB): 1xx
-                // Bit 6:       1xx
-                // ...
-                
-                // For simplicity in this generated code, I'll use a lookup table
-                // mapping 4 bits of color to 12 bits of SPI (1.5 bytes? awkward).
-                
-                // Let's just do the "1 bit = 1 byte" approach at **6.0 MHz**.
-                // '0' = 0xF0 (High 0.33us? No, 6MHz is 0.16us period).
-                // T0H = 0.4us = ~2.4 bits. T0L = 0.85us = ~5 bits.
-                // Pattern 11100000 (0xE0) = 3 high (0.5us), 5 low (0.8us). Close enough.
-                // T1H = 0.8us = ~5 bits. T1L = 0.45us = ~2.5 bits.
-                // Pattern 11111000 (0xF8) = 5 high (0.8us), 3 low (0.5us).
-                
-                // So at 6.0 MHz: 
-                // '0' -> 0xE0
-                // '1' -> 0xF8
-                
-                spi_buffer[buf_idx++] = ((val >> bit) & 1) ? 0xF8 : 0xE0;
-            }
+        led_count += s->num_leds;
+
+        s->go = SDL_CreateSemaphore(0);
+        s->done = SDL_CreateSemaphore(0);
+        s->thread = s->go && s->done ? SDL_CreateThread(strip_thread_entry, "WS2812Strip", s) : NULL;
+        if (!s->thread) {
+            printf("WS2812: Failed to start strip thread (%s).\n", SDL_GetError());
+            ws2812_close();
+            return false;
         }
     }
+    return true;
+}
 
-    // Reset signal (60 bytes of 0 at end)
-    for(int k=0; k<60; k++) spi_buffer[buf_idx++] = 0x00;
+bool ws2812_update(led_color_t* colors) {
+    if (strip_count == 0) return false;
+    uint64_t t0 = mono_time_us();
 
-    // Send
-    struct spi_ioc_transfer tr = {
-        .tx_buf = (unsigned long)spi_buffer,
-        .rx_buf = 0,
-        .len = buf_idx,
-        .speed_hz = 6000000, // 6 MHz
-        .delay_usecs = 0,
-        .bits_per_word = 8,
-    };
+    for (int i = 0; i < strip_count; i++) ws2812_encode(colors + strips[i].first_led, strips[i].num_leds, strips[i].buf);
 
-    ioctl(spi_fd, SPI_IOC_MESSAGE(1), &tr);
+    for (int i = 0; i < strip_count; i++) SDL_SemPost(strips[i].go);
+    for (int i = 0; i < strip_count; i++) SDL_SemWait(strips[i].done);
+
+    bool ok = true;
+    for (int i = 0; i < strip_count; i++) {
+        strip_t* s = &strips[i];
+        if (s->ok) continue;
+        ok = false;
+        if (s->failures++ > 0) continue;
+        if (s->err) fprintf(stderr, "WS2812: %s: SPI transfer failed: %s\n", s->device, strerror(s->err));
+        else printf("WS2812: %s: pause between transfers reached the reset %d times running; frame dropped.\n",
+                    s->device, SEND_TRIES);
+    }
+
+    histogram_add(&update_time, mono_time_us() - t0);
+    return ok;
+}
+
+void ws2812_print_stats(void) {
+    if (!update_time.count) return;
+    histogram_print(&update_time, "WS2812: ", "update time", 1.0, "us");
+    for (int i = 0; i < strip_count; i++) {
+        strip_t* s = &strips[i];
+        printf("WS2812:   %s: %d LEDs, %llu transfers, %llu failed updates",
+               s->device, s->num_leds, (unsigned long long)s->transfers, (unsigned long long)s->failures);
+        if (s->len > s->chunk)
+            printf(", %llu resent after a pause latched, longest pause between chunks %llu us",
+                   (unsigned long long)s->resends, (unsigned long long)s->max_gap_us);
+        printf("\n");
+    }
 }
 
 void ws2812_close(void) {
-    if (spi_buffer) free(spi_buffer);
-    if (spi_fd >= 0) close(spi_fd);
+    atomic_store(&stopping, true);
+    for (int i = 0; i < strip_count; i++) {
+        strip_t* s = &strips[i];
+        if (s->thread) {
+            SDL_SemPost(s->go);
+            SDL_WaitThread(s->thread, NULL);
+        }
+        if (s->go) SDL_DestroySemaphore(s->go);
+        if (s->done) SDL_DestroySemaphore(s->done);
+        if (s->buf) free(s->buf);
+        if (s->fd >= 0) close(s->fd);
+        memset(s, 0, sizeof(*s));
+        s->fd = -1;
+    }
+    strip_count = 0;
+    led_count = 0;
 }
 
 #else
 // --- WINDOWS DUMMY DRIVER ---
-bool ws2812_init(int num_leds) {
-    led_count = num_leds;
-    printf("WS2812: Windows Simulation Initialized (%d LEDs)\n", num_leds);
+bool ws2812_init_strips(const ws2812_strip_t* strips, int count) {
+    if (count < 1 || count > WS2812_MAX_STRIPS) return false;
+    led_count = 0;
+    for (int i = 0; i < count; i++) led_count += strips[i].num_leds;
+    printf("WS2812: Windows Simulation Initialized (%d LEDs on %d strips)\n", led_count, count);
     return true;
 }
 
-void ws2812_update(led_color_t* colors) {
+bool ws2812_update(led_color_t* colors) {
     // Debug print only occasionally to not spam
     static int skip = 0;
     if (skip++ % 30 == 0) {
         printf("LEDs: [%d %d %d] ...\n", colors[0].r, colors[0].g, colors[0].b);
     }
+    return true;
 }
 
+
+void ws2812_print_stats(void) {}
+
 void ws2812_close(void) {
     printf("WS2812: Closed.\n");
 }
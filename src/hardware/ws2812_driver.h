@@ -11,11 +11,32 @@ typedef struct {
     uint8_t b;
 } led_color_t;
 
-// Initialize SPI for WS2812
+#define WS2812_MAX_STRIPS 4
+
+// One strip on its own spidev device
+typedef struct {
+    const char* device;     // e.g. "/dev/spidev0.0"
+    int num_leds;
+} ws2812_strip_t;
+
+// Initialize SPI for WS2812: one strip on /dev/spidev0.0
 bool ws2812_init(int num_leds);
 
-// Update all LEDs with the array of colors
-void ws2812_update(led_color_t* colors);
+// Several strips, any length. ws2812_update takes their colours back to
+// back in this order. Updates longer than spidev's bufsiz go out as
+// several transfers, split between LEDs; if the pause between two reaches
+// the reset time the strip has latched half a frame, and it is sent again.
+bool ws2812_init_strips(const ws2812_strip_t* strips, int count);
+
+// LEDs on all strips together
+int ws2812_led_count(void);
+
+// Update all LEDs with the array of colors. Strips are sent in parallel,
+// one real-time thread each; returns when all of them are out. False if a strip
+// failed and may show a partial frame: send it again.
+bool ws2812_update(led_color_t* colors);
+
+void ws2812_print_stats(void);
 
 // Cleanup
 void ws2812_close(void);
@@ -0,0 +1,28 @@
+#include "ws2812_encode.h"
+#include <stdbool.h>
+#include <string.h>
+
+static uint8_t lut[256][3];
+static bool lut_ready = false;
+
+static void build_lut(void) {
+    for (int v = 0; v < 256; v++) {
+        uint32_t bits = 0;
+        for (int bit = 7; bit >= 0; bit--) bits = (bits << 3) | (((v >> bit) & 1) ? 0x6u : 0x4u);
+        lut[v][0] = (uint8_t)(bits >> 16);
+        lut[v][1] = (uint8_t)(bits >> 8);
+        lut[v][2] = (uint8_t)bits;
+    }
+    lut_ready = true;
+}
+
+void ws2812_encode(const led_color_t* colors, int num_leds, uint8_t* out) {
+    if (!lut_ready) build_lut();
+    for (int i = 0; i < num_leds; i++) {
+        memcpy(out, lut[colors[i].g], 3);
+        memcpy(out + 3, lut[colors[i].r], 3);
+        memcpy(out + 6, lut[colors[i].b], 3);
+        out += WS2812_BYTES_PER_LED;
+    }
+    memset(out, 0, WS2812_RESET_BYTES);
+}
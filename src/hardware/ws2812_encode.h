@@ -0,0 +1,25 @@
+#ifndef WS2812_ENCODE_H
+#define WS2812_ENCODE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ws2812_driver.h"
+
+// WS2812 bitstream for SPI MOSI at 2.4 MHz: every data bit becomes three SPI
+// bits of 417 ns, 100 for a 0 (0.42 us high, 0.83 us low) and 110 for a 1
+// (0.83 us high, 0.42 us low), so one colour byte is exactly three SPI bytes.
+// Bytes are expanded through a 256-entry table, GRB order, MSB first.
+
+#define WS2812_SPI_HZ         2400000
+#define WS2812_BYTES_PER_LED  9         // 24 data bits x 3 SPI bits
+#define WS2812_RESET_BYTES    24        // 80 us low after the data latches the colours
+#define WS2812_RESET_US       50        // Low this long and the strip latches what it has
+
+static inline size_t ws2812_encoded_size(int num_leds) {
+    return (size_t)num_leds * WS2812_BYTES_PER_LED + WS2812_RESET_BYTES;
+}
+
+// Write ws2812_encoded_size(num_leds) bytes to out: the data, then the reset
+void ws2812_encode(const led_color_t* colors, int num_leds, uint8_t* out);
+
+#endif // WS2812_ENCODE_H
@@ -3,7 +3,12 @@
 
 #include <stdint.h>
 
+// Default pixel format; --color picks another at run time
+#ifdef MR2_RGB565
+#define LV_COLOR_DEPTH 16
+#else
 #define LV_COLOR_DEPTH 32
+#endif
 
 // Use standard C library functions
 #define LV_USE_STDLIB_MALLOC    LV_STDLIB_CLIB
@@ -13,17 +18,32 @@
 // Memory
 #define LV_MEM_SIZE (128 * 1024U) // 128kB
 
-// Tick interface
-#define LV_TICK_CUSTOM 1
-#if LV_TICK_CUSTOM
-    #define LV_TICK_CUSTOM_INCLUDE <SDL.h>         /*Header for the system time function*/
-    #define LV_TICK_CUSTOM_SYS_TIME_EXPR (SDL_GetTicks())     /*Expression evaluating to current system time in ms*/
+// Tick: main.c installs the monotonic clock with lv_tick_set_cb()
+
+// Software draw units, each rendering on its own thread. CMake sets
+// MR2_DRAW_THREADS; 1 renders on the main thread without an OS layer.
+// Only the main thread calls LVGL (flush included), the units only draw.
+#ifndef MR2_DRAW_THREADS
+#define MR2_DRAW_THREADS 1
+#endif
+#if MR2_DRAW_THREADS > 1 && defined(__linux__)
+#define LV_USE_OS                   LV_OS_PTHREAD
+#define LV_DRAW_SW_DRAW_UNIT_CNT    MR2_DRAW_THREADS
+// glibc on aarch64 rejects stacks below 128 KiB (PTHREAD_STACK_MIN)
+#define LV_DRAW_THREAD_STACK_SIZE   (128 * 1024)
+#else
+#define LV_USE_OS                   LV_OS_NONE
+#define LV_DRAW_SW_DRAW_UNIT_CNT    1
 #endif
 
 // Enable Widgets
 #define LV_USE_LABEL 1
 #define LV_USE_BAR   1
 #define LV_USE_ARC   1
+#define LV_USE_IMAGE 1
+
+// Static UI layer is rendered once with lv_snapshot_take()
+#define LV_USE_SNAPSHOT 1
 
 // Fonts
 #define LV_FONT_MONTSERRAT_14 1
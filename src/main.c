@@ -1,105 +1,950 @@
 #include <SDL.h>
 #include "lvgl.h"
 #include "ui/ui.h"
+#include "ui/round_mask.h"
 #include "can/can_bus.h"
+#include "can/can_history.h"
+#include "can/can_recorder.h"
+#include "can/can_replay.h"
 #include "hardware/ws2812_driver.h"
 #include "hardware/led_logic.h"
+#include "hardware/led_output.h"
+#include "hardware/shift_predict.h"
+#include "hardware/drm_display.h"
+#include "util/mono_time.h"
+#include "util/histogram.h"
+#include "util/frame_sched.h"
+#include "util/frame_prof.h"
+#include "util/rgb565.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
 
 #define WINDOW_WIDTH 720
 #define WINDOW_HEIGHT 720
 
+// Data channel behind each UI readout
+static const can_channel_t readout_channels[UI_READOUT_COUNT] = {
+    [UI_RPM] = CAN_CH_RPM,             [UI_SPEED] = CAN_CH_SPEED,
+    [UI_BOOST] = CAN_CH_BOOST,         [UI_OIL_PRESS] = CAN_CH_OIL_PRESS,
+    [UI_CLT] = CAN_CH_CLT,             [UI_OIL_TEMP] = CAN_CH_OIL_TEMP,
+    [UI_EGT] = CAN_CH_EGT,             [UI_IAT] = CAN_CH_IAT,
+};
+
+// --- FRAME STATISTICS ---
+static histogram_t ui_latency;          // CAN frame received -> frame presented (us)
+static histogram_t ui_frame_time;       // Loop pass that produced a frame: update, render, present (us)
+static histogram_t ui_frame_interval;   // Between presented frames (us)
+static histogram_t ui_frame_px;         // Pixels refreshed per presented frame
+static histogram_t ui_flush_time;       // Flush callback time per presented frame: copy or unlock (us)
+static histogram_t ui_draw_tasks;       // LVGL draw tasks per frame (--bench-render only)
+static uint64_t copy_bytes_total = 0;   // Bytes the CPU copied into the texture
+static uint64_t unshown_rx_us = 0;      // Oldest receive time applied but not yet on screen
+static uint64_t last_present_us = 0;
+static uint64_t loop_wakeups = 0;
+static uint64_t ui_updates = 0;
+static uint64_t frames_presented = 0;
+
+// LVGL tick source: the shared monotonic clock, in ms
+static uint32_t lvgl_tick_ms(void) {
+    return (uint32_t)(mono_time_us() / 1000u);
+}
+
 // --- SDL Driver for LVGL ---
 static SDL_Window * window;
 static SDL_Renderer * renderer;
 static SDL_Texture * texture;
+static bool flushed = false;     // Texture changed since the last present
+static uint64_t frame_px = 0;    // Pixels refreshed since the last present
+static uint64_t frame_copy_bytes = 0; // Bytes the CPU copied into the texture since the last present
+static uint64_t frame_flush_ns = 0;   // Time spent in the flush callback since the last present
+
+// --- PIXEL FORMAT (--color) ---
+// 8888: LVGL, texture and scanout all ARGB8888 / XRGB8888.
+// 565: all RGB565, half the memory and bandwidth per pixel.
+// 565-dither: LVGL still renders ARGB8888 and the copy flush converts to
+// RGB565 with an ordered dither, for dark gradients that band in 16 bit.
+static int px_size = 4;                  // Bytes per pixel LVGL renders
+static int tex_px_size = 4;              // Bytes per pixel of the texture / scanout
+static bool dither565 = false;
+static uint16_t* convert_buf = NULL;     // One converted band, 565-dither only
+
+// --- DIRECT RENDERING ---
+// Both direct paths (locked texture, DRM back buffer) hand LVGL a new draw
+// buffer at LV_EVENT_RENDER_START and need to know what it will redraw:
+// the bounding box of the areas invalidated since the last render, and for
+// DRM the areas themselves (LVGL redraws each of them, possibly merged into
+// larger ones, and nothing else).
+static int screen_w = WINDOW_WIDTH;
+static int screen_h = WINDOW_HEIGHT;
+static lv_area_t inv_area;
+static bool inv_area_valid = false;
+
+#define INV_LIST_MAX 32
+static drm_rect_t inv_list[INV_LIST_MAX];
+static int inv_list_count = 0;          // Past INV_LIST_MAX the rest is left out: all still get redrawn
+
+static void inv_area_event_cb(lv_event_t* e) {
+    const lv_area_t* a = lv_event_get_param(e);
+    if (inv_list_count < INV_LIST_MAX) {
+        drm_rect_t* r = &inv_list[inv_list_count++];
+        r->x1 = a->x1; r->y1 = a->y1; r->x2 = a->x2; r->y2 = a->y2;
+    }
+    if (!inv_area_valid) {
+        inv_area = *a;
+        inv_area_valid = true;
+    } else {
+        if (a->x1 < inv_area.x1) inv_area.x1 = a->x1;
+        if (a->y1 < inv_area.y1) inv_area.y1 = a->y1;
+        if (a->x2 > inv_area.x2) inv_area.x2 = a->x2;
+        if (a->y2 > inv_area.y2) inv_area.y2 = a->y2;
+    }
+}
+
+// Clipped to the screen; the whole screen if nothing was recorded
+static lv_area_t take_inv_area(void) {
+    lv_area_t a = { 0, 0, screen_w - 1, screen_h - 1 };
+    if (inv_area_valid) {
+        if (inv_area.x1 > a.x1) a.x1 = inv_area.x1;
+        if (inv_area.y1 > a.y1) a.y1 = inv_area.y1;
+        if (inv_area.x2 < a.x2) a.x2 = inv_area.x2;
+        if (inv_area.y2 < a.y2) a.y2 = inv_area.y2;
+        inv_area_valid = false;
+    }
+    inv_list_count = 0;
+    return a;
+}
+
+// --- ZERO-COPY FLUSH (--flush lock) ---
+// LVGL renders in DIRECT mode straight into the streaming texture. Before each
+// render the bounding box of the invalidated areas is locked and the texture
+// memory handed to LVGL as its draw buffer; the last flush of the frame
+// unlocks it, so the only transfer left is the renderer's own upload.
+// Needs a lock that returns a persistent, full pitch buffer (software, OpenGL
+// and GLES2 renderers keep one); zero_copy_probe() checks that at start-up.
+static bool zero_copy = false;
+static uint8_t* tex_pixels = NULL;       // Texture memory of pixel (0,0)
+static bool tex_locked = false;
+static uint8_t* shadow_buf = NULL;       // Draw buffer when a lock fails at run time
+static bool repaint = false;             // Texture memory moved, redraw everything
+static uint32_t lock_failures = 0;
+static uint32_t lock_moves = 0;
+
+static bool zero_copy_probe(void) {
+    void* p;
+    int pitch;
+    if (SDL_LockTexture(texture, NULL, &p, &pitch) != 0) {
+        printf("UI: SDL_LockTexture failed (%s).\n", SDL_GetError());
+        return false;
+    }
+    uint8_t* base = p;
+    bool ok = pitch == WINDOW_WIDTH * px_size;
+    if (ok) {
+        memset(base, 0, (size_t)pitch * WINDOW_HEIGHT);
+        base[(WINDOW_HEIGHT / 2) * pitch + (WINDOW_WIDTH / 2) * px_size] = 0x5A;
+    } else {
+        printf("UI: texture pitch %d, LVGL needs %d.\n", pitch, WINDOW_WIDTH * px_size);
+    }
+    SDL_UnlockTexture(texture);
+    if (!ok) return false;
+
+    // A locked sub-rectangle must point into the same memory, contents kept
+    SDL_Rect r = { WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2, 16, 16 };
+    if (SDL_LockTexture(texture, &r, &p, &pitch) != 0) return false;
+    ok = (uint8_t*)p == base + r.y * pitch + r.x * px_size && *(uint8_t*)p == 0x5A;
+    *(uint8_t*)p = 0;
+    SDL_UnlockTexture(texture);
+    if (!ok) {
+        printf("UI: texture lock does not keep its contents.\n");
+        return false;
+    }
+    tex_pixels = base;
+    return true;
+}
+
+static void zero_copy_render_cb(lv_event_t* e) {
+    lv_display_t* display = lv_event_get_user_data(e);
+
+    // Lock what is about to be drawn
+    lv_area_t a = take_inv_area();
+    SDL_Rect r = { a.x1, a.y1, a.x2 - a.x1 + 1, a.y2 - a.y1 + 1 };
+
+    void* p;
+    int pitch;
+    uint8_t* buf;
+    if (SDL_LockTexture(texture, &r, &p, &pitch) == 0 && pitch == WINDOW_WIDTH * px_size) {
+        buf = (uint8_t*)p - r.y * pitch - r.x * px_size;
+        if (buf != tex_pixels) {
+            // Whatever was outside the locked area is gone
+            lock_moves++;
+            tex_pixels = buf;
+            repaint = true;
+        }
+        tex_locked = true;
+    } else {
+        // Render into a private buffer this time and copy in the flush
+        if (lock_failures++ == 0) printf("UI: texture lock failed (%s), copying instead.\n", SDL_GetError());
+        if (!shadow_buf) shadow_buf = malloc((size_t)WINDOW_WIDTH * WINDOW_HEIGHT * px_size);
+        if (!shadow_buf) abort();
+        buf = shadow_buf;
+    }
+    lv_display_set_buffers(display, buf, NULL, WINDOW_WIDTH * WINDOW_HEIGHT * px_size, LV_DISPLAY_RENDER_MODE_DIRECT);
+}
+
+// --- DRM/KMS OUTPUT (--display drm) ---
+// LVGL renders in DIRECT mode into the DRM back buffer; present() queues
+// the page flip. No SDL window, renderer or texture.
+static bool use_drm = false;
+static bool drm_frame_open = false;      // Back buffer taken, frame not yet queued
+
+static void drm_render_cb(lv_event_t* e) {
+    lv_display_t* display = lv_event_get_user_data(e);
+    int count = inv_list_count;
+    lv_area_t a = take_inv_area();
+    if (drm_frame_open) return;     // Started at set-up, already covers the screen
+    if (count == 0) {
+        // Nothing recorded: the whole screen
+        inv_list[0].x1 = a.x1; inv_list[0].y1 = a.y1; inv_list[0].x2 = a.x2; inv_list[0].y2 = a.y2;
+        count = 1;
+    }
+    uint8_t* buf = drm_display_begin_frame(inv_list, count);
+    lv_display_set_buffers(display, buf, NULL, (uint32_t)(screen_w * screen_h * px_size), LV_DISPLAY_RENDER_MODE_DIRECT);
+    drm_frame_open = true;
+}
+
+static bool can_render(void) {
+    return !use_drm || drm_frame_open || drm_display_can_render();
+}
+
+// --- ROUND PANEL MASK ---
+// Only the inscribed circle of the panel is visible. round_mask trims what
+// LVGL invalidates; the copy flush also skips the corners of what it
+// uploads (in FULL mode, where nothing is invalidated, that is the only
+// saving). The corners of the texture are cleared once at start-up.
+static bool use_mask = true;
+
+#define MASK_UPLOAD_ROWS 16
+
+// Upload area from src (stride bytes per row), corners left out
+static void upload_area(const lv_area_t* area, const uint8_t* src, int32_t stride) {
+    lv_area_t bands[WINDOW_HEIGHT / MASK_UPLOAD_ROWS + 1];
+    int n = 1;
+    if (use_mask) n = round_mask_bands(area, MASK_UPLOAD_ROWS, bands, (int)(sizeof(bands) / sizeof(bands[0])));
+    else bands[0] = *area;
+
+    for (int i = 0; i < n; i++) {
+        SDL_Rect rect;
+        rect.x = bands[i].x1;
+        rect.y = bands[i].y1;
+        rect.w = lv_area_get_width(&bands[i]);
+        rect.h = lv_area_get_height(&bands[i]);
+        const uint8_t* p = src + (bands[i].y1 - area->y1) * stride + (bands[i].x1 - area->x1) * px_size;
+        if (dither565) {
+            rgb565_convert(p, stride, convert_buf, rect.w * 2, rect.w, rect.h, rect.x, rect.y, true);
+            SDL_UpdateTexture(texture, &rect, convert_buf, rect.w * 2);
+        } else {
+            SDL_UpdateTexture(texture, &rect, p, stride);
+        }
+        frame_copy_bytes += (uint64_t)rect.w * (uint64_t)rect.h * (uint64_t)tex_px_size;
+    }
+}
+
+static void clear_texture(void) {
+    void* p;
+    int pitch;
+    if (SDL_LockTexture(texture, NULL, &p, &pitch) != 0) return;
+    memset(p, 0, (size_t)pitch * WINDOW_HEIGHT);
+    SDL_UnlockTexture(texture);
+}
 
 static void display_flush_cb(lv_display_t * display, const lv_area_t * area, uint8_t * px_map) {
+    uint64_t t0 = mono_time_ns();
     int32_t width = lv_area_get_width(area);
     int32_t height = lv_area_get_height(area);
 
-    SDL_Rect rect;
-    rect.x = area->x1;
-    rect.y = area->y1;
-    rect.w = width;
-    rect.h = height;
-
-    SDL_UpdateTexture(texture, &rect, px_map, width * 4); 
+    if (use_drm) {
+        // Already in the back buffer
+    } else if (tex_locked) {
+        // Already in the texture, unlocking uploads the locked area
+        if (lv_display_flush_is_last(display)) {
+            SDL_UnlockTexture(texture);
+            tex_locked = false;
+        }
+    } else if (zero_copy) {
+        // px_map is a whole screen, the area sits at its screen position
+        upload_area(area, px_map + (area->y1 * WINDOW_WIDTH + area->x1) * px_size, WINDOW_WIDTH * px_size);
+    } else {
+        // Only the refreshed area goes to the texture (the whole screen in FULL mode)
+        upload_area(area, px_map, width * px_size);
+    }
+    frame_px += (uint64_t)width * (uint64_t)height;
+    frame_flush_ns += mono_time_ns() - t0;
+    flushed = true;
     lv_display_flush_ready(display);
 }
 
-int main(int argc, char **argv) {
-    (void)argc; (void)argv;
+static void present(void) {
+    FRAME_PROF_START(t);
+    if (use_drm) {
+        if (drm_frame_open) {
+            drm_display_end_frame(unshown_rx_us);
+            drm_frame_open = false;
+            FRAME_PROF_STOP(FRAME_PROF_PRESENT, t);
+        }
+        return;
+    }
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, texture, NULL, NULL);
+    SDL_RenderPresent(renderer);
+    FRAME_PROF_STOP(FRAME_PROF_PRESENT, t);
+    if (repaint) {
+        repaint = false;
+        lv_obj_invalidate(lv_screen_active());
+    }
+}
 
-    if (SDL_Init(SDL_INIT_VIDEO) != 0) return 1;
+static void close_display(void) {
+    if (use_drm) {
+        drm_display_close();
+        return;
+    }
+    SDL_DestroyTexture(texture);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+}
 
-    window = SDL_CreateWindow("MR2 Dashboard", 
-        SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 
-        WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
-        
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, 
-        SDL_TEXTUREACCESS_STREAMING, WINDOW_WIDTH, WINDOW_HEIGHT);
+static void count_present(uint64_t pass_start_us) {
+    uint64_t now = mono_time_us();
+    frames_presented++;
+    histogram_add(&ui_frame_time, now - pass_start_us);
+    histogram_add(&ui_frame_px, frame_px);
+    histogram_add(&ui_flush_time, frame_flush_ns / 1000);
+    frame_prof_add(FRAME_PROF_FLUSH, frame_flush_ns);
+    frame_prof_add(FRAME_PROF_PASS, (now - pass_start_us) * 1000);
+    copy_bytes_total += frame_copy_bytes;
+    frame_px = 0;
+    frame_flush_ns = 0;
+    frame_copy_bytes = 0;
+    if (last_present_us) histogram_add(&ui_frame_interval, now - last_present_us);
+    last_present_us = now;
+    if (unshown_rx_us) {
+        histogram_add(&ui_latency, now > unshown_rx_us ? now - unshown_rx_us : 0);
+        unshown_rx_us = 0;
+    }
+}
 
-    lv_init();
+// Optional run time limit for unattended runs (--run-seconds)
+static uint64_t quit_at_us = 0;
 
-    lv_display_t * display = lv_display_create(WINDOW_WIDTH, WINDOW_HEIGHT);
-    lv_display_set_flush_cb(display, display_flush_cb);
-    
-    #define BUF_SIZE (WINDOW_WIDTH * WINDOW_HEIGHT) 
-    static uint32_t buf1[BUF_SIZE];
-    lv_display_set_buffers(display, buf1, NULL, BUF_SIZE * 4, LV_DISPLAY_RENDER_MODE_FULL);
+static bool time_is_up(void) {
+    return quit_at_us && mono_time_us() >= quit_at_us;
+}
 
-    if (!can_init("can0")) printf("Warning: CAN init failed.\n");
-    
-    // Initialize Hardware LEDs (8 LEDs)
-    if (!ws2812_init(8)) printf("Warning: LED init failed (SPI disabled?).\n");
+// --- DATA -> UI ---
+static uint32_t shown_seq = 0;
+
+// Shift light frame source, runs on the LED output thread at its own rate
+// so the redline blink keeps its rhythm whatever the display does.
+// The bar is the first 8 LEDs, anything after them on the strips stays off.
+static void shift_light_frame(led_color_t* out, int num_leds) {
+    led_color_t bar[SHIFT_LIGHT_LEDS];
+    can_snapshot_t snap;
+    can_get_snapshot(&snap);
+
+    // Gear and coolant limits only apply while they are being received
+    uint64_t now_us = mono_time_us();
+    int gear = 0, clt = SHIFT_LIGHT_CLT_UNKNOWN;
+    if (can_channel_status(&snap, CAN_CH_GEAR, now_us) == CAN_STATUS_FRESH) gear = (int)snap.values[CAN_CH_GEAR];
+    if (can_channel_status(&snap, CAN_CH_CLT, now_us) == CAN_STATUS_FRESH) clt = (int)snap.values[CAN_CH_CLT];
+    int rpm = (int)snap.values[CAN_CH_RPM];
+    if (shift_predict_enabled()) rpm = shift_predict_rpm(rpm, shift_lights_redline(gear, clt), now_us);
+    calculate_shift_lights(rpm, gear, clt, bar);
+    memset(out, 0, (size_t)num_leds * sizeof(led_color_t));
+    memcpy(out, bar, (size_t)(num_leds < SHIFT_LIGHT_LEDS ? num_leds : SHIFT_LIGHT_LEDS) * sizeof(led_color_t));
+}
+
+// Pull the latest CAN snapshot into the widgets. Returns true if it held new data.
+static bool apply_can_data(void) {
+    FRAME_PROF_START(t_read);
+    can_snapshot_t snap;
+    can_get_snapshot(&snap);
+
+    uint64_t now_us = mono_time_us();
+    for (int r = 0; r < UI_READOUT_COUNT; r++) {
+        ui_set_stale((ui_readout_t)r, can_channel_status(&snap, readout_channels[r], now_us) != CAN_STATUS_FRESH);
+    }
+    FRAME_PROF_STOP(FRAME_PROF_CAN_READ, t_read);
 
-    SDL_Thread *thread = SDL_CreateThread(can_thread_entry, "CANThread", NULL);
+    if (snap.seq == shown_seq) return false;
+    shown_seq = snap.seq;
+    ui_updates++;
 
-    ui_init();
+    int rpm = (int)snap.values[CAN_CH_RPM];
+    int speed = (int)snap.values[CAN_CH_SPEED];
+    float boost = snap.values[CAN_CH_BOOST];
+    float oil_press = snap.values[CAN_CH_OIL_PRESS];
+    int clt = (int)snap.values[CAN_CH_CLT];
+    int oil_t = (int)snap.values[CAN_CH_OIL_TEMP];
+    int egt = (int)snap.values[CAN_CH_EGT];
+    int iat = (int)snap.values[CAN_CH_IAT];
+    FRAME_PROF_START(t_ui);
+    ui_update_data(rpm, speed, boost, oil_press, clt, oil_t, egt, iat);
+    FRAME_PROF_STOP(FRAME_PROF_UI_UPDATE, t_ui);
 
+    if (!unshown_rx_us) unshown_rx_us = snap.rx_us;
+    return true;
+}
+
+// --- MAIN LOOPS ---
+// Original fixed-rate polling loop, kept for comparison (--legacy-loop)
+static void run_polling_loop(void) {
     bool quit = false;
     SDL_Event event;
-    
-    led_color_t leds[8];
 
     while (!quit) {
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) quit = true;
         }
+        if (time_is_up()) quit = true;
+        frame_prof_poll();
+        loop_wakeups++;
+        uint64_t pass_start = mono_time_us();
+
+        apply_can_data();
+
+        FRAME_PROF_START(t_timers);
+        lv_timer_handler();
+        FRAME_PROF_STOP(FRAME_PROF_TIMERS, t_timers);
+
+        present();
+        if (flushed) {
+            flushed = false;
+            count_present(pass_start);
+        }
+
+        SDL_Delay(5); 
+    }
+}
+
+// Anything invalidated since the last render, new data or not (event loop)
+static bool invalidated = false;
+
+static void dirty_event_cb(lv_event_t* e) {
+    (void)e;
+    invalidated = true;
+}
+
+// Sleeps until the CAN thread publishes, an SDL event arrives, an LVGL timer
+// is due or a held back frame may be drawn. New data is rendered right away
+// unless the previous frame was less than frame_us ago.
+static void run_event_loop(lv_display_t* display, uint64_t frame_us) {
+    bool quit = false;
+    bool pending = true;        // Invalidated, not yet rendered; the first frame is
+    uint64_t next_frame_us = 0;
+    SDL_Event event;
+
+    // Only the lv_refr_now below renders: LVGL's refresh timer would draw
+    // frames --max-fps holds back, and wait on a busy DRM buffer
+    lv_timer_pause(lv_display_get_refr_timer(display));
+    lv_display_add_event_cb(display, dirty_event_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+
+    while (!quit) {
+        frame_prof_poll();
+        loop_wakeups++;
+        uint64_t now = mono_time_us();
+
+        can_notify_ack();
+        apply_can_data();
+        if (invalidated) pending = true;
+
+        // With DRM, a frame waits for a free buffer; the flip wakes us
+        if (pending && now >= next_frame_us && can_render()) {
+            // Render now instead of waiting for the display refresh timer
+            FRAME_PROF_START(t_render);
+            invalidated = false;
+            lv_refr_now(display);
+            FRAME_PROF_STOP(FRAME_PROF_RENDER, t_render);
+            pending = false;
+            next_frame_us = now + frame_us;
+        }
+
+        FRAME_PROF_START(t_timers);
+        uint32_t idle_ms = lv_timer_handler();
+        FRAME_PROF_STOP(FRAME_PROF_TIMERS, t_timers);
+        if (invalidated) pending = true;     // Animations, staleness
+        if (flushed) {
+            flushed = false;
+            present();
+            count_present(now);
+        }
+
+        // Next wake up: LVGL timers, or the held back frame
+        uint64_t wait_us = (idle_ms == LV_NO_TIMER_READY) ? 100000 : (uint64_t)idle_ms * 1000;
+        if (wait_us > 100000) wait_us = 100000;
+        if (pending && can_render()) {
+            now = mono_time_us();
+            uint64_t until = next_frame_us > now ? next_frame_us - now : 0;
+            if (until < wait_us) wait_us = until;
+        }
+
+        int wait_ms = (int)((wait_us + 999) / 1000);
+        int got = wait_ms > 0 ? SDL_WaitEventTimeout(&event, wait_ms) : SDL_PollEvent(&event);
+        while (got) {
+            // CAN events need no handling here, waking up was the point
+            if (event.type == SDL_QUIT) quit = true;
+            got = SDL_PollEvent(&event);
+        }
+        if (time_is_up()) quit = true;
+    }
+}
 
-        // 1. Get Data
-        int rpm = can_get_rpm();
-        int speed = can_get_speed();
-        float boost = can_get_boost();
-        float oil_press = can_get_oil_press();
-        int clt = can_get_coolant_temp();
-        int oil_t = can_get_oil_temp();
-        int egt = can_get_egt();
-        int iat = can_get_iat();
+// Fixed-rate loop (--pacing deadline|vsync): one pass per refresh period.
+// deadline sleeps until the next absolute deadline; vsync leaves the waiting
+// to SDL_RenderPresent on a PRESENTVSYNC renderer and only measures.
+static void run_paced_loop(lv_display_t* display, frame_sched_t* sched, bool vsync) {
+    bool quit = false;
+    SDL_Event event;
 
-        // 2. Update UI
-        ui_update_data(rpm, speed, boost, oil_press, clt, oil_t, egt, iat);
+    while (!quit) {
+        if (vsync) frame_sched_tick(sched);
+        else frame_sched_wait(sched);
+        frame_prof_poll();
+        loop_wakeups++;
+        uint64_t pass_start = mono_time_us();
 
-        // 3. Update Hardware LEDs
-        calculate_shift_lights(rpm, leds);
-        ws2812_update(leds);
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT) quit = true;
+        }
+        if (time_is_up()) quit = true;
 
-        lv_tick_inc(5);
+        apply_can_data();
+        FRAME_PROF_START(t_timers);
         lv_timer_handler();
+        FRAME_PROF_STOP(FRAME_PROF_TIMERS, t_timers);
+        // Whatever changed is drawn in this period, not at LVGL's refresh timer
+        FRAME_PROF_START(t_render);
+        lv_refr_now(display);
+        FRAME_PROF_STOP(FRAME_PROF_RENDER, t_render);
 
-        SDL_RenderClear(renderer);
-        SDL_RenderCopy(renderer, texture, NULL, NULL);
-        SDL_RenderPresent(renderer);
+        if (flushed) {
+            flushed = false;
+            present();
+            count_present(pass_start);
+        } else if (vsync) {
+            present();      // Keeps the loop on the vertical blank
+        }
+    }
+}
 
-        SDL_Delay(5); 
+// Synthetic RPM sweep rendered back to back, no CAN involved (--bench-render).
+// Run once per render mode to compare pixels and bytes per frame.
+static void run_render_bench(lv_display_t* display, int frames) {
+    for (int i = 0; i < frames; i++) {
+        // 4 s idle -> redline -> idle triangle at 60 fps
+        int phase = i % 240;
+        int rpm = 800 + (phase < 120 ? phase : 240 - phase) * 7700 / 120;
+        float boost = (float)rpm / 8500.0f * 2.5f - 1.0f;
+        float oil_press = 1.5f + (float)rpm / 2000.0f;
+        uint64_t t0 = mono_time_us();
+        FRAME_PROF_START(t_ui);
+        ui_update_data(rpm, rpm / 60, boost, oil_press, 88, 96, 300 + rpm / 15, 35);
+        FRAME_PROF_STOP(FRAME_PROF_UI_UPDATE, t_ui);
+        FRAME_PROF_START(t_render);
+        lv_refr_now(display);
+        FRAME_PROF_STOP(FRAME_PROF_RENDER, t_render);
+        if (flushed) {
+            flushed = false;
+            present();
+            count_present(t0);
+        }
+        histogram_add(&ui_draw_tasks, ui_take_draw_tasks());
+    }
+    histogram_print(&ui_frame_time, "BENCH: ", "frame time", 1000.0, "ms");
+    histogram_print(&ui_draw_tasks, "BENCH: ", "LVGL draw calls per frame", 1.0, "tasks");
+    histogram_print(&ui_frame_px, "BENCH: ", "pixels refreshed per frame", 1000.0, "kpx");
+    histogram_print(&ui_flush_time, "BENCH: ", "flush time per frame", 1.0, "us");
+    printf("BENCH: %.1f%% of the screen refreshed, %.1f KiB copied by the CPU per frame on average\n",
+           ui_frame_px.count ? 100.0 * (double)ui_frame_px.sum / (double)ui_frame_px.count / (screen_w * screen_h) : 0.0,
+           ui_frame_px.count ? (double)copy_bytes_total / 1024.0 / (double)ui_frame_px.count : 0.0);
+}
+
+// --replay-speed: a factor above 0, or "max" for flat out
+static bool parse_replay_speed(const char* arg, double* speed) {
+    if (strcmp(arg, "max") == 0) {
+        *speed = CAN_REPLAY_MAX_SPEED;
+        return true;
+    }
+    char* end;
+    double v = strtod(arg, &end);
+    if (end == arg || *end != '\0' || !(v > 0.0) || !isfinite(v)) return false;
+    *speed = v;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    // --- Command line ---
+    int can_batch = CAN_BATCH_DEFAULT;
+    int can_wait_us = 0;
+    bool legacy_loop = false;
+    const char* pacing = "event";
+    int history_s = CAN_HISTORY_DEFAULT_SECONDS;
+    int history_kb = CAN_HISTORY_DEFAULT_BUDGET_KB;
+    const char* rec_dir = "recordings";
+    int rec_ring_kb = CAN_RECORDER_DEFAULT_RING_KB;
+    int rec_max_mb = CAN_RECORDER_DEFAULT_MAX_MB;
+    int rec_sync_ms = CAN_RECORDER_DEFAULT_SYNC_MS;
+    const char* can_if = "can0";
+    const char* replay_file = NULL;
+    const char* replay_to = NULL;
+    double replay_speed = 1.0;
+    int run_seconds = 0;
+    bool partial_render = true;
+    int draw_buf_div = 10;
+    int bench_frames = 0;
+    bool flush_lock = false;
+    bool cache_static = true;
+    int led_hz = 200;
+    int led_keepalive_ms = 1000;
+    int shift_lead_ms = 0;
+    bool shift_log = false;
+    ws2812_strip_t led_strips[WS2812_MAX_STRIPS];
+    int led_strip_count = 0;
+    const char* color = LV_COLOR_DEPTH == 16 ? "565" : "8888";
+    bool drm_display = false;
+    const char* drm_card = "/dev/dri/card0";
+    int drm_buffers = 3;
+    int max_fps = 60;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--can-batch") == 0 && i + 1 < argc) {
+            can_batch = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--can-wait-us") == 0 && i + 1 < argc) {
+            can_wait_us = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--emu-base") == 0 && i + 1 < argc) {
+            can_set_emu_base((uint32_t)strtoul(argv[++i], NULL, 0));
+        } else if (strcmp(argv[i], "--stale-ms") == 0 && i + 1 < argc) {
+            can_set_stale_timeout_ms(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--dbc") == 0 && i + 1 < argc) {
+            if (!can_load_dbc(argv[++i])) printf("Warning: DBC load failed, using built-in EMU decoder only.\n");
+        } else if (strcmp(argv[i], "--can-extra-id") == 0 && i + 1 < argc) {
+            if (!can_add_filter_id((uint32_t)strtoul(argv[++i], NULL, 0)))
+                printf("Warning: too many extra CAN IDs, ignoring %s\n", argv[i]);
+        } else if (strcmp(argv[i], "--can-no-filter") == 0) {
+            can_set_filtering(false);
+        } else if (strcmp(argv[i], "--history-s") == 0 && i + 1 < argc) {
+            history_s = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--history-kb") == 0 && i + 1 < argc) {
+            history_kb = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rec-dir") == 0 && i + 1 < argc) {
+            rec_dir = argv[++i];
+        } else if (strcmp(argv[i], "--no-rec") == 0) {
+            rec_dir = NULL;
+        } else if (strcmp(argv[i], "--rec-ring-kb") == 0 && i + 1 < argc) {
+            rec_ring_kb = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rec-max-mb") == 0 && i + 1 < argc) {
+            rec_max_mb = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rec-sync-ms") == 0 && i + 1 < argc) {
+            rec_sync_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--export-candump") == 0 && i + 1 < argc) {
+            // Offline conversion, no UI
+            return can_log_export_candump(argv[++i], stdout) ? 0 : 1;
+        } else if (strcmp(argv[i], "--can-if") == 0 && i + 1 < argc) {
+            can_if = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_file = argv[++i];
+        } else if (strcmp(argv[i], "--replay-speed") == 0 && i + 1 < argc &&
+                   parse_replay_speed(argv[i + 1], &replay_speed)) {
+            // Anything else falls through to the usage line
+            i++;
+        } else if (strcmp(argv[i], "--replay-to") == 0 && i + 1 < argc) {
+            replay_to = argv[++i];
+        } else if (strcmp(argv[i], "--render-mode") == 0 && i + 1 < argc &&
+                   (strcmp(argv[i + 1], "partial") == 0 || strcmp(argv[i + 1], "full") == 0)) {
+            // Anything else falls through to the usage line
+            partial_render = strcmp(argv[++i], "partial") == 0;
+        } else if (strcmp(argv[i], "--draw-buf-div") == 0 && i + 1 < argc) {
+            draw_buf_div = atoi(argv[++i]);
+            if (draw_buf_div < 1) draw_buf_div = 1;
+        } else if (strcmp(argv[i], "--display") == 0 && i + 1 < argc &&
+                   (strcmp(argv[i + 1], "sdl") == 0 || strcmp(argv[i + 1], "drm") == 0)) {
+            drm_display = strcmp(argv[++i], "drm") == 0;
+        } else if (strcmp(argv[i], "--drm-card") == 0 && i + 1 < argc) {
+            drm_card = argv[++i];
+        } else if (strcmp(argv[i], "--drm-buffers") == 0 && i + 1 < argc) {
+            drm_buffers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--flush") == 0 && i + 1 < argc &&
+                   (strcmp(argv[i + 1], "copy") == 0 || strcmp(argv[i + 1], "lock") == 0)) {
+            flush_lock = strcmp(argv[++i], "lock") == 0;
+        } else if (strcmp(argv[i], "--color") == 0 && i + 1 < argc) {
+            color = argv[++i];
+        } else if (strcmp(argv[i], "--bench-render") == 0 && i + 1 < argc) {
+            bench_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--run-seconds") == 0 && i + 1 < argc) {
+            run_seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-fps") == 0 && i + 1 < argc) {
+            max_fps = atoi(argv[++i]);
+            if (max_fps < 1) max_fps = 1;
+        } else if (strcmp(argv[i], "--pacing") == 0 && i + 1 < argc &&
+                   (strcmp(argv[i + 1], "event") == 0 || strcmp(argv[i + 1], "deadline") == 0 ||
+                    strcmp(argv[i + 1], "vsync") == 0)) {
+            // Anything else falls through to the usage line
+            pacing = argv[++i];
+        } else if (strcmp(argv[i], "--led-hz") == 0 && i + 1 < argc) {
+            led_hz = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--led-keepalive-ms") == 0 && i + 1 < argc) {
+            led_keepalive_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--shift-profile") == 0 && i + 1 < argc) {
+            if (!shift_lights_load(argv[++i])) printf("Warning: shift light profile not loaded, using the built-in one.\n");
+        } else if (strcmp(argv[i], "--shift-lead-ms") == 0 && i + 1 < argc) {
+            shift_lead_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--shift-log") == 0) {
+            shift_log = true;
+        } else if (strcmp(argv[i], "--led-strip") == 0 && i + 1 < argc) {
+            // DEV:COUNT, the last ':' separates them
+            char* spec = argv[++i];
+            char* colon = strrchr(spec, ':');
+            if (!colon || led_strip_count == WS2812_MAX_STRIPS) {
+                printf("Warning: ignoring --led-strip %s (DEV:COUNT, at most %d strips).\n", spec, WS2812_MAX_STRIPS);
+                continue;
+            }
+            *colon = '\0';
+            led_strips[led_strip_count].device = spec;
+            led_strips[led_strip_count].num_leds = atoi(colon + 1);
+            led_strip_count++;
+        } else if (strcmp(argv[i], "--no-bg-cache") == 0) {
+            cache_static = false;
+        } else if (strcmp(argv[i], "--no-mask") == 0) {
+            use_mask = false;
+        } else if (strcmp(argv[i], "--legacy-loop") == 0) {
+            legacy_loop = true;
+        } else {
+            printf("Usage: %s [--can-batch N] [--can-wait-us US] [--emu-base ID] [--stale-ms MS] [--dbc FILE] [--can-extra-id ID]... [--can-no-filter] [--history-s S] [--history-kb KB] [--rec-dir DIR | --no-rec] [--rec-ring-kb KB] [--rec-max-mb MB] [--rec-sync-ms MS] [--export-candump LOG] [--can-if IF] [--replay LOG [--replay-speed X|max] [--replay-to IF]] [--render-mode partial|full] [--draw-buf-div N] [--flush copy|lock] [--color 8888|565|565-dither] [--display sdl|drm] [--drm-card DEV] [--drm-buffers 2|3] [--no-mask] [--no-bg-cache] [--led-hz N] [--led-keepalive-ms MS] [--led-strip DEV:COUNT]... [--shift-profile FILE] [--shift-lead-ms MS] [--shift-log] [--bench-render FRAMES] [--run-seconds S] [--max-fps N] [--pacing event|deadline|vsync] [--legacy-loop]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (strcmp(color, "565") == 0) {
+        px_size = tex_px_size = 2;
+    } else if (strcmp(color, "565-dither") == 0) {
+        if (drm_display || flush_lock) {
+            // Nothing to convert: LVGL renders straight into the scanout / texture
+            printf("Warning: no dithering when rendering in place, using plain RGB565.\n");
+            px_size = 2;
+        } else {
+            dither565 = true;
+            convert_buf = malloc((size_t)WINDOW_WIDTH * WINDOW_HEIGHT * 2);
+            if (!convert_buf) return 1;
+        }
+        tex_px_size = 2;
+    } else if (strcmp(color, "8888") != 0) {
+        printf("Warning: unknown --color %s, using 8888.\n", color);
+    }
+
+    bool vsync = strcmp(pacing, "vsync") == 0;
+    bool paced = vsync || strcmp(pacing, "deadline") == 0;
+    if (vsync && drm_display) {
+        printf("UI: page flips already wait for the vblank, pacing by deadline.\n");
+        vsync = false;
+    }
+
+    if (drm_display) {
+        // SDL only carries events here (CAN wake-ups, flips, quit)
+        if (SDL_Init(SDL_INIT_EVENTS) != 0) return 1;
+        if (!drm_display_init(drm_card, WINDOW_WIDTH, WINDOW_HEIGHT, drm_buffers, px_size * 8)) return 1;
+        use_drm = true;
+        screen_w = drm_display_width();
+        screen_h = drm_display_height();
+        if (screen_w != WINDOW_WIDTH || screen_h != WINDOW_HEIGHT)
+            printf("Warning: no %dx%d mode, drawing the dash centred on %dx%d.\n",
+                   WINDOW_WIDTH, WINDOW_HEIGHT, screen_w, screen_h);
+    } else {
+        if (SDL_Init(SDL_INIT_VIDEO) != 0) return 1;
+
+        window = SDL_CreateWindow("MR2 Dashboard", 
+            SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 
+            WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
+            
+        Uint32 vsync_flag = vsync ? SDL_RENDERER_PRESENTVSYNC : 0;
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | vsync_flag);
+        if (!renderer) {
+            // Headless runs (SDL_VIDEODRIVER=dummy / offscreen) have no GPU
+            printf("Warning: no accelerated renderer (%s), using software.\n", SDL_GetError());
+            renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE | vsync_flag);
+            if (!renderer) return 1;
+        }
+        texture = SDL_CreateTexture(renderer, tex_px_size == 2 ? SDL_PIXELFORMAT_RGB565 : SDL_PIXELFORMAT_ARGB8888, 
+            SDL_TEXTUREACCESS_STREAMING, WINDOW_WIDTH, WINDOW_HEIGHT);
+        if (!texture) return 1;
+        printf("UI: %s texture, %d KiB.\n", tex_px_size == 2 ? "RGB565" : "ARGB8888",
+               WINDOW_WIDTH * WINDOW_HEIGHT * tex_px_size / 1024);
+        // The masked corners are never uploaded
+        clear_texture();
+    }
+
+    lv_init();
+    // Set at build time (MR2_DRAW_THREADS); the flush still runs on this thread
+    if (LV_DRAW_SW_DRAW_UNIT_CNT > 1) printf("UI: %d software draw threads.\n", LV_DRAW_SW_DRAW_UNIT_CNT);
+    // Animations and the shift light blink follow the real time
+    lv_tick_set_cb(lvgl_tick_ms);
+    frame_prof_init();
+
+    lv_display_t * display = lv_display_create(screen_w, screen_h);
+    lv_display_set_flush_cb(display, display_flush_cb);
+    // Before any buffer is set, the buffer checks use the stride of this format
+    lv_display_set_color_format(display, px_size == 2 ? LV_COLOR_FORMAT_RGB565 : LV_COLOR_FORMAT_ARGB8888);
+    // First invalidate handler, the ones below see the trimmed areas. The
+    // circle is the 720x720 dash's, centred on whatever mode DRM found.
+    if (use_mask && !round_mask_init(display, screen_w, screen_h, WINDOW_WIDTH)) return 1;
+    
+    #define BUF_SIZE (WINDOW_WIDTH * WINDOW_HEIGHT) 
+    if (use_drm) {
+        // First frame: the whole screen, lv_display_create invalidated it
+        drm_rect_t all = { 0, 0, screen_w - 1, screen_h - 1 };
+        uint8_t* buf = drm_display_begin_frame(&all, 1);
+        drm_frame_open = true;
+        lv_display_set_buffers(display, buf, NULL, (uint32_t)(screen_w * screen_h * px_size), LV_DISPLAY_RENDER_MODE_DIRECT);
+        lv_display_add_event_cb(display, inv_area_event_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+        lv_display_add_event_cb(display, drm_render_cb, LV_EVENT_RENDER_START, display);
+        printf("UI: DRM/KMS output, LVGL renders into the back buffer.\n");
+    } else if (flush_lock && zero_copy_probe()) {
+        // Draw buffer is set to the locked texture before every render
+        zero_copy = true;
+        lv_display_set_buffers(display, tex_pixels, NULL, BUF_SIZE * px_size, LV_DISPLAY_RENDER_MODE_DIRECT);
+        lv_display_add_event_cb(display, inv_area_event_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+        lv_display_add_event_cb(display, zero_copy_render_cb, LV_EVENT_RENDER_START, display);
+        printf("UI: zero-copy flush, LVGL renders into the locked texture.\n");
+    } else if (partial_render) {
+        if (flush_lock) printf("Warning: renderer does not allow zero-copy flush, copying.\n");
+        // Two small buffers: LVGL renders only the invalidated areas and the
+        // flush callback uploads just those rectangles
+        uint32_t buf_px = BUF_SIZE / (uint32_t)draw_buf_div;
+        uint32_t buf_bytes = buf_px * (uint32_t)px_size;
+        void* draw_buf1 = malloc(buf_bytes);
+        void* draw_buf2 = malloc(buf_bytes);
+        if (!draw_buf1 || !draw_buf2) return 1;
+        lv_display_set_buffers(display, draw_buf1, draw_buf2, buf_bytes, LV_DISPLAY_RENDER_MODE_PARTIAL);
+        printf("UI: partial rendering, 2 x %u KiB draw buffers.\n", buf_bytes / 1024);
+    } else {
+        if (flush_lock) printf("Warning: renderer does not allow zero-copy flush, copying.\n");
+        uint32_t buf_bytes = BUF_SIZE * (uint32_t)px_size;
+        void* buf1 = malloc(buf_bytes);
+        if (!buf1) return 1;
+        lv_display_set_buffers(display, buf1, NULL, buf_bytes, LV_DISPLAY_RENDER_MODE_FULL);
+        printf("UI: full frame rendering, %u KiB draw buffer.\n", buf_bytes / 1024);
     }
 
+    histogram_reset(&ui_latency);
+    histogram_reset(&ui_frame_time);
+    histogram_reset(&ui_frame_interval);
+    histogram_reset(&ui_frame_px);
+    histogram_reset(&ui_flush_time);
+
+    ui_init(cache_static);
+
+    if (bench_frames > 0) {
+        // Draw the initial screen first so only the sweep is measured
+        lv_refr_now(display);
+        histogram_reset(&ui_draw_tasks);
+        ui_count_draw_tasks();
+        present();
+        flushed = false;
+        frame_px = 0;
+        frame_flush_ns = 0;
+        frame_copy_bytes = 0;
+        run_render_bench(display, bench_frames);
+        round_mask_print_stats();
+        frame_prof_print();
+        if (use_drm) drm_display_print_stats();
+        close_display();
+        SDL_Quit();
+        return 0;
+    }
+
+    can_set_batch(can_batch, can_wait_us);
+    if (history_kb > 0 && !can_history_init(history_s, (size_t)history_kb * 1024))
+        printf("Warning: channel history disabled.\n");
+    // Replay: straight into the decoder, or onto an interface (vcan) we also listen on
+    if (replay_file) {
+        if (!can_replay_setup(replay_file, replay_speed, replay_to)) return 1;
+        if (replay_to) can_if = replay_to;
+        rec_dir = NULL;     // Do not record the replay
+    }
+    bool replay_direct = replay_file && !replay_to;
+
+    if (replay_direct) can_init_replay();
+    else if (!can_init(can_if)) printf("Warning: CAN init failed.\n");
+    if (rec_dir && !can_recorder_start(rec_dir, can_if, rec_ring_kb, rec_sync_ms, rec_max_mb))
+        printf("Warning: CAN recorder not running.\n");
+    
+    // Initialize Hardware LEDs (8 LEDs unless --led-strip), driven from their own thread
+    if (led_strip_count == 0) {
+        led_strips[0].device = "/dev/spidev0.0";
+        led_strips[0].num_leds = 8;
+        led_strip_count = 1;
+    }
+    shift_predict_init(shift_lead_ms, shift_log);
+    if (!ws2812_init_strips(led_strips, led_strip_count)) printf("Warning: LED init failed (SPI disabled?).\n");
+    else if (!led_output_start(ws2812_led_count(), shift_light_frame, led_hz, led_keepalive_ms))
+        printf("Warning: shift lights not running.\n");
+
+    // The CAN thread wakes the event loop through an SDL user event
+    uint32_t can_event = (legacy_loop || paced) ? (uint32_t)-1 : SDL_RegisterEvents(1);
+    if (can_event != (uint32_t)-1) can_set_notify_event(can_event);
+    // Completed flips wake it too, a frame may be waiting for the buffer
+    if (use_drm && can_event != (uint32_t)-1) drm_display_set_notify_event(SDL_RegisterEvents(1));
+
+    SDL_Thread *thread = replay_direct ? NULL : SDL_CreateThread(can_thread_entry, "CANThread", NULL);
+    if (replay_file) SDL_CreateThread(can_replay_thread_entry, "CANReplay", NULL);
+
+    uint64_t loop_start_us = mono_time_us();
+    if (run_seconds > 0) quit_at_us = loop_start_us + (uint64_t)run_seconds * 1000000u;
+    clock_t cpu_start = clock();
+
+    frame_sched_t sched;
+    if (legacy_loop) {
+        printf("UI: polling loop (5 ms).\n");
+        run_polling_loop();
+    } else if (paced) {
+        printf("UI: %s paced loop at %d Hz.\n", vsync ? "vsync" : "deadline", max_fps);
+        frame_sched_init(&sched, max_fps);
+        run_paced_loop(display, &sched, vsync);
+    } else {
+        printf("UI: event driven loop (max %d fps).\n", max_fps);
+        run_event_loop(display, 1000000u / (uint64_t)max_fps);
+    }
+
+    double secs = (double)(mono_time_us() - loop_start_us) / 1e6;
+    if (secs <= 0.0) secs = 1e-6;
+    printf("UI: %llu wakeups (%.0f/s), %llu data updates (%.0f/s), %llu frames (%.1f fps), process CPU %.1f%%\n",
+           (unsigned long long)loop_wakeups, (double)loop_wakeups / secs,
+           (unsigned long long)ui_updates, (double)ui_updates / secs,
+           (unsigned long long)frames_presented, (double)frames_presented / secs,
+           100.0 * (double)(clock() - cpu_start) / CLOCKS_PER_SEC / secs);
+    if (paced && !legacy_loop) frame_sched_print(&sched, "UI: ");
+    histogram_print(&ui_latency, "UI: ", "CAN frame to screen latency", 1000.0, "ms");
+    histogram_print(&ui_frame_time, "UI: ", "frame time", 1000.0, "ms");
+    histogram_print(&ui_frame_interval, "UI: ", "frame interval", 1000.0, "ms");
+    histogram_print(&ui_frame_px, "UI: ", "pixels refreshed per frame", 1000.0, "kpx");
+    histogram_print(&ui_flush_time, "UI: ", "flush time per frame", 1.0, "us");
+    printf("UI: %.1f MiB copied into the texture by the CPU (%.2f MB/s)\n",
+           (double)copy_bytes_total / (1024.0 * 1024.0), (double)copy_bytes_total / 1e6 / secs);
+    if (lock_failures || lock_moves)
+        printf("UI: zero-copy %u lock failures, %u texture moves\n", lock_failures, lock_moves);
+
+    round_mask_print_stats();
+    frame_prof_print();
+    if (use_drm) drm_display_print_stats();
+    can_print_stats();
+    can_recorder_stop();
+    can_recorder_print_stats();
+
+    led_output_stop();
+    led_output_print_stats();
+    shift_predict_print_stats();
+    ws2812_print_stats();
     ws2812_close();
-    SDL_DestroyTexture(texture);
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
+    close_display();
     SDL_Quit();
 
     return 0;
@@ -0,0 +1,140 @@
+#include "round_mask.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+static int16_t* span_x1 = NULL;     // Per row; x1 > x2 means nothing visible
+static int16_t* span_x2 = NULL;
+static int mask_w = 0, mask_h = 0;
+static bool splitting = false;      // Our own band invalidations are passing through
+
+static uint64_t px_invalidated = 0;
+static uint64_t px_kept = 0;
+
+bool round_mask_row(int y, int32_t* x1, int32_t* x2) {
+    if (y < 0 || y >= mask_h || span_x1[y] > span_x2[y]) return false;
+    *x1 = span_x1[y];
+    *x2 = span_x2[y];
+    return true;
+}
+
+int round_mask_bands(const lv_area_t* area, int band_h, lv_area_t* out, int max) {
+    int n = 0;
+    int32_t y_end = area->y2 < mask_h - 1 ? area->y2 : mask_h - 1;
+    int32_t y = area->y1 > 0 ? area->y1 : 0;
+
+    while (y <= y_end) {
+        int32_t band_y2 = (y / band_h + 1) * band_h - 1;
+        if (band_y2 > y_end) band_y2 = y_end;
+
+        // Widest visible span in the band
+        int32_t x1 = mask_w, x2 = -1;
+        for (int32_t r = y; r <= band_y2; r++) {
+            if (span_x1[r] > span_x2[r]) continue;
+            if (span_x1[r] < x1) x1 = span_x1[r];
+            if (span_x2[r] > x2) x2 = span_x2[r];
+        }
+        if (x1 < area->x1) x1 = area->x1;
+        if (x2 > area->x2) x2 = area->x2;
+
+        if (x1 <= x2) {
+            lv_area_t* last = n ? &out[n - 1] : NULL;
+            if (last && last->x1 == x1 && last->x2 == x2 && last->y2 == y - 1) {
+                last->y2 = band_y2;
+            } else if (n == max) {
+                // Out of room: grow the last band over this one
+                if (x1 < last->x1) last->x1 = x1;
+                if (x2 > last->x2) last->x2 = x2;
+                last->y2 = band_y2;
+            } else {
+                out[n].x1 = x1;
+                out[n].y1 = y;
+                out[n].x2 = x2;
+                out[n].y2 = band_y2;
+                n++;
+            }
+        }
+        y = band_y2 + 1;
+    }
+    return n;
+}
+
+static void invalidate_cb(lv_event_t* e) {
+    if (splitting) return;
+    lv_display_t* disp = lv_event_get_user_data(e);
+    lv_area_t* area = lv_event_get_param(e);
+    int32_t h = lv_area_get_height(area);
+
+    // Band height so the area fits in ROUND_MASK_MAX_BANDS, rounded to 8
+    // rows so bands of overlapping areas line up and LVGL can merge them
+    int band_h = (h + ROUND_MASK_MAX_BANDS - 1) / ROUND_MASK_MAX_BANDS;
+    band_h = band_h < 16 ? 16 : (band_h + 7) & ~7;
+
+    lv_area_t bands[ROUND_MASK_MAX_BANDS];
+    int n = round_mask_bands(area, band_h, bands, ROUND_MASK_MAX_BANDS);
+
+    px_invalidated += lv_area_get_size(area);
+    if (n == 0) {
+        // Entirely in a corner. The event cannot drop the area, so shrink it
+        // to the centre pixel, which nearly every redraw covers anyway.
+        area->x1 = area->x2 = mask_w / 2;
+        area->y1 = area->y2 = mask_h / 2;
+        px_kept++;
+        return;
+    }
+
+    uint32_t kept = 0;
+    for (int i = 0; i < n; i++) kept += lv_area_get_size(&bands[i]);
+    if (n > 1 && kept > lv_area_get_size(area) - lv_area_get_size(area) / 8) {
+        // Not worth the extra slots in LVGL's invalid area list
+        px_kept += lv_area_get_size(area);
+        return;
+    }
+
+    px_kept += kept;
+    *area = bands[0];
+    splitting = true;
+    for (int i = 1; i < n; i++) lv_inv_area(disp, &bands[i]);
+    splitting = false;
+}
+
+bool round_mask_init(lv_display_t* disp, int width, int height, int diameter) {
+    span_x1 = malloc((size_t)height * sizeof(int16_t));
+    span_x2 = malloc((size_t)height * sizeof(int16_t));
+    if (!span_x1 || !span_x2) return false;
+    mask_w = width;
+    mask_h = height;
+
+    // A pixel is visible if its centre lies inside the circle
+    double cx = width / 2.0, cy = height / 2.0;
+    int fit = width < height ? width : height;
+    double r = (diameter < fit ? diameter : fit) / 2.0;
+    uint64_t visible = 0;
+    for (int y = 0; y < height; y++) {
+        double dy = y + 0.5 - cy;
+        span_x1[y] = 1;
+        span_x2[y] = 0;
+        if (dy * dy >= r * r) continue;
+        double half = sqrt(r * r - dy * dy);
+        int x1 = (int)ceil(cx - half - 0.5);
+        int x2 = (int)floor(cx + half - 0.5);
+        if (x1 < 0) x1 = 0;
+        if (x2 > width - 1) x2 = width - 1;
+        if (x1 > x2) continue;
+        span_x1[y] = (int16_t)x1;
+        span_x2[y] = (int16_t)x2;
+        visible += (uint64_t)(x2 - x1 + 1);
+    }
+
+    lv_display_add_event_cb(disp, invalidate_cb, LV_EVENT_INVALIDATE_AREA, disp);
+    printf("UI: Round panel mask, %.1f%% of the pixels visible.\n",
+           100.0 * (double)visible / ((double)width * height));
+    return true;
+}
+
+void round_mask_print_stats(void) {
+    if (!px_invalidated) return;
+    printf("UI: round mask trimmed invalidated areas to %.1f%% (%llu of %llu px)\n",
+           100.0 * (double)px_kept / (double)px_invalidated,
+           (unsigned long long)px_kept, (unsigned long long)px_invalidated);
+}
@@ -0,0 +1,31 @@
+#ifndef ROUND_MASK_H
+#define ROUND_MASK_H
+
+#include "lvgl.h"
+
+// The 720x720 panel is round: only the inscribed circle is visible. The
+// visible span of every row is computed once. Invalidated areas are cut
+// into horizontal bands trimmed to those spans, so LVGL does not render
+// the corners, and the flush uses the same bands to skip uploading them.
+
+// Most bands one invalidated area is split into; LVGL keeps 32 areas
+// (LV_INV_BUF_SIZE) before falling back to a full-screen redraw
+#define ROUND_MASK_MAX_BANDS 8
+
+// Compute the spans for a width x height display and hook its
+// LV_EVENT_INVALIDATE_AREA. The circle is centred on the display, like the
+// dash, and diameter across (clamped to the display). Register before
+// other invalidate handlers so they see the trimmed areas.
+bool round_mask_init(lv_display_t* disp, int width, int height, int diameter);
+
+// Visible part of row y: false if none
+bool round_mask_row(int y, int32_t* x1, int32_t* x2);
+
+// Cut area into bands of band_h rows (aligned to multiples of band_h),
+// each trimmed to the widest visible span in it. Returns the number of
+// bands written, at most max (the last one grows to cover the rest).
+int round_mask_bands(const lv_area_t* area, int band_h, lv_area_t* out, int max);
+
+void round_mask_print_stats(void);
+
+#endif // ROUND_MASK_H
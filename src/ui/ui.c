@@ -1,5 +1,6 @@
 #include "ui.h"
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 
 // --- Configuration ---
@@ -8,6 +9,7 @@
 #define COLOR_SCREEN_BG lv_color_hex(0x222222) 
 #define COLOR_BOX_BG    lv_color_hex(0x000000) 
 #define COLOR_TEXT      lv_color_hex(0xFFFFFF)
+#define COLOR_STALE     lv_color_hex(0x555555)
 
 // --- Custom Fonts ---
 LV_FONT_DECLARE(carbon_100);
@@ -33,9 +35,30 @@ static lv_obj_t * label_oilt_val;
 static lv_obj_t * container_clt;
 static lv_obj_t * label_clt_val;
 
+static bool stale[UI_READOUT_COUNT];
+static bool clt_alarm = false;
+static bool oilt_alarm = false;
+
+// Indicator colour last applied to a side arc
+typedef enum { ARC_NORMAL, ARC_ALARM, ARC_STALE } arc_state_t;
+static arc_state_t boost_arc_state = ARC_NORMAL;
+static arc_state_t oilp_arc_state = ARC_NORMAL;
+// Last values shown, to recolour the arcs when their staleness changes
+static float shown_boost = 0.0f;
+static float shown_oil_press = 0.0f;
+
+// --- Static Layer ---
+// Everything that never changes after start-up (background, arc tracks,
+// captions, box backgrounds and titles) is built on one full-screen object,
+// rendered once with lv_snapshot_take() and shown as a single opaque image
+// under the live widgets. A redrawn area then costs one image blit instead
+// of every static widget overlapping it.
+static lv_draw_buf_t * static_layer = NULL;
+static uint32_t draw_tasks = 0;
+
 // --- Helpers ---
 
-static lv_obj_t * create_stat_box(lv_obj_t * parent, const char * title, int x, int y, lv_obj_t ** out_val_label) {
+static lv_obj_t * create_box(lv_obj_t * parent, int x, int y) {
     lv_obj_t * cont = lv_obj_create(parent);
     lv_obj_set_size(cont, 180, 110);
     lv_obj_align(cont, LV_ALIGN_CENTER, x, y);
@@ -43,25 +66,150 @@ static lv_obj_t * create_stat_box(lv_obj_t * parent, const char * title, int x,
     lv_obj_set_style_radius(cont, 8, 0); 
     lv_obj_set_style_border_width(cont, 0, 0);
     lv_obj_clear_flag(cont, LV_OBJ_FLAG_SCROLLABLE);
+    return cont;
+}
 
-    *out_val_label = lv_label_create(cont);
-    lv_obj_align(*out_val_label, LV_ALIGN_CENTER, 0, -10);
-    lv_obj_set_style_text_font(*out_val_label, &carbon_42, 0); 
-    lv_obj_set_style_text_color(*out_val_label, COLOR_TEXT, 0);
-    lv_label_set_text(*out_val_label, "0");
-
+static lv_obj_t * create_box_title(lv_obj_t * cont, const char * title) {
     lv_obj_t * lbl = lv_label_create(cont);
     lv_obj_align(lbl, LV_ALIGN_BOTTOM_MID, 0, -5);
     lv_obj_set_style_text_font(lbl, &carbon_20, 0); 
     lv_obj_set_style_text_color(lbl, lv_color_hex(0xAAAAAA), 0);
     lv_label_set_text(lbl, title);
+    return lbl;
+}
+
+// Background and title go on the static layer. The live box on top is
+// transparent; in alarm it gets a burgundy background and its own title.
+static lv_obj_t * create_stat_box(lv_obj_t * static_parent, lv_obj_t * parent, const char * title,
+                                  int x, int y, lv_obj_t ** out_val_label) {
+    create_box_title(create_box(static_parent, x, y), title);
+
+    lv_obj_t * cont = create_box(parent, x, y);
+    lv_obj_set_style_bg_color(cont, COLOR_BURGUNDY, 0);
+    lv_obj_set_style_bg_opa(cont, LV_OPA_TRANSP, 0);
 
+    *out_val_label = lv_label_create(cont);
+    lv_obj_align(*out_val_label, LV_ALIGN_CENTER, 0, -10);
+    lv_obj_set_style_text_font(*out_val_label, &carbon_42, 0); 
+    lv_obj_set_style_text_color(*out_val_label, COLOR_TEXT, 0);
+    lv_label_set_text(*out_val_label, "0");
+
+    lv_obj_add_flag(create_box_title(cont, title), LV_OBJ_FLAG_HIDDEN);
     return cont;
 }
 
-void ui_init(void) {
+static void set_box_alarm(lv_obj_t * cont, bool * state, bool alarm) {
+    if (!cont || *state == alarm) return;
+    *state = alarm;
+    lv_obj_set_style_bg_opa(cont, alarm ? LV_OPA_COVER : LV_OPA_TRANSP, 0);
+    lv_obj_t * title = lv_obj_get_child(cont, 1);
+    if (alarm) lv_obj_clear_flag(title, LV_OBJ_FLAG_HIDDEN);
+    else lv_obj_add_flag(title, LV_OBJ_FLAG_HIDDEN);
+}
+
+// Only on change: a local style invalidates the whole 700x700 arc
+static void set_arc_state(lv_obj_t * arc, arc_state_t * state, arc_state_t next) {
+    if (!arc || *state == next) return;
+    *state = next;
+    lv_color_t color = next == ARC_STALE ? COLOR_STALE : next == ARC_ALARM ? COLOR_BURGUNDY : COLOR_TEAL;
+    lv_obj_set_style_arc_color(arc, color, LV_PART_INDICATOR);
+}
+
+static arc_state_t boost_arc(void) {
+    return stale[UI_BOOST] ? ARC_STALE : shown_boost > 1.6f ? ARC_ALARM : ARC_NORMAL;
+}
+
+static arc_state_t oilp_arc(void) {
+    return stale[UI_OIL_PRESS] ? ARC_STALE : shown_oil_press < 1.5f ? ARC_ALARM : ARC_NORMAL;
+}
+
+// Relabel only when the text changes; setting it always invalidates the label
+static void set_label_text(lv_obj_t * label, const char * text) {
+    if (label && strcmp(lv_label_get_text(label), text) != 0) lv_label_set_text(label, text);
+}
+
+static void set_label_int(lv_obj_t * label, int value) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%d", value);
+    set_label_text(label, buf);
+}
+
+static void set_label_float(lv_obj_t * label, float value) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%.1f", value);
+    set_label_text(label, buf);
+}
+
+// Dark track of a side arc
+static void create_arc_track(lv_obj_t * parent, int start, int end) {
+    lv_obj_t * arc = lv_arc_create(parent);
+    lv_obj_set_size(arc, 700, 700); 
+    lv_obj_align(arc, LV_ALIGN_CENTER, 0, 0);
+    lv_arc_set_bg_angles(arc, start, end);
+    lv_arc_set_rotation(arc, 0);
+    lv_obj_set_style_arc_width(arc, 30, LV_PART_MAIN);
+    lv_obj_set_style_arc_color(arc, lv_color_hex(0x111111), LV_PART_MAIN);
+    lv_obj_set_style_arc_rounded(arc, false, LV_PART_MAIN); 
+    lv_obj_set_style_arc_opa(arc, LV_OPA_TRANSP, LV_PART_INDICATOR);
+    lv_obj_remove_style(arc, NULL, LV_PART_KNOB);
+}
+
+static lv_obj_t * create_static_layer(lv_obj_t * scr) {
+    lv_obj_t * layer = lv_obj_create(scr);
+    lv_obj_remove_style_all(layer);
+    lv_obj_set_size(layer, lv_pct(100), lv_pct(100));
+    lv_obj_set_style_bg_color(layer, COLOR_SCREEN_BG, 0);
+    lv_obj_set_style_bg_opa(layer, LV_OPA_COVER, 0);
+    lv_obj_clear_flag(layer, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+    return layer;
+}
+
+// Replace the static layer by an image of it. Opaque (no alpha) so LVGL
+// treats it as covering and skips the screen background below it too.
+static void bake_static_layer(lv_obj_t * scr, lv_obj_t * layer) {
+    lv_color_format_t cf = lv_display_get_color_format(lv_obj_get_display(scr)) == LV_COLOR_FORMAT_RGB565
+                         ? LV_COLOR_FORMAT_RGB565 : LV_COLOR_FORMAT_XRGB8888;
+    lv_obj_update_layout(scr);
+    static_layer = lv_snapshot_take(layer, cf);
+    if (!static_layer) {
+        printf("Warning: static layer snapshot failed, drawing it live.\n");
+        return;
+    }
+    lv_obj_delete(layer);
+
+    lv_obj_t * img = lv_image_create(scr);
+    lv_image_set_src(img, static_layer);
+    lv_obj_set_pos(img, 0, 0);
+    lv_obj_move_to_index(img, 0);
+    printf("UI: static layer cached, %u KiB.\n", (unsigned)(static_layer->data_size / 1024));
+}
+
+static void count_draw_task_cb(lv_event_t * e) {
+    (void)e;
+    draw_tasks++;
+}
+
+static void count_draw_tasks_of(lv_obj_t * obj) {
+    lv_obj_add_flag(obj, LV_OBJ_FLAG_SEND_DRAW_TASK_EVENTS);
+    lv_obj_add_event_cb(obj, count_draw_task_cb, LV_EVENT_DRAW_TASK_ADDED, NULL);
+    for (uint32_t i = 0; i < lv_obj_get_child_count(obj); i++) count_draw_tasks_of(lv_obj_get_child(obj, (int32_t)i));
+}
+
+void ui_count_draw_tasks(void) {
+    count_draw_tasks_of(lv_screen_active());
+}
+
+uint32_t ui_take_draw_tasks(void) {
+    uint32_t n = draw_tasks;
+    draw_tasks = 0;
+    return n;
+}
+
+void ui_init(bool cache_static) {
     lv_obj_t * scr = lv_screen_active();
     lv_obj_set_style_bg_color(scr, COLOR_SCREEN_BG, LV_PART_MAIN);
+    // Static widgets: baked into an image below, or drawn live on the screen
+    lv_obj_t * bg = cache_static ? create_static_layer(scr) : scr;
 
     // --- 1. Center Stack ---
     label_rpm_digit = lv_label_create(scr);
@@ -70,7 +218,7 @@ void ui_init(void) {
     lv_obj_set_style_text_font(label_rpm_digit, &carbon_100, 0); 
     lv_label_set_text(label_rpm_digit, "0");
 
-    lv_obj_t * lbl_rpm = lv_label_create(scr);
+    lv_obj_t * lbl_rpm = lv_label_create(bg);
     lv_obj_align_to(lbl_rpm, label_rpm_digit, LV_ALIGN_OUT_BOTTOM_MID, 0, -15);
     lv_obj_set_style_text_color(lbl_rpm, lv_color_hex(0x666666), 0);
     lv_obj_set_style_text_font(lbl_rpm, &carbon_20, 0);
@@ -82,29 +230,30 @@ void ui_init(void) {
     lv_obj_set_style_text_font(label_speed, &carbon_80, 0); 
     lv_label_set_text(label_speed, "0");
     
-    lv_obj_t * lbl_kmh = lv_label_create(scr);
+    lv_obj_t * lbl_kmh = lv_label_create(bg);
     lv_obj_align_to(lbl_kmh, label_speed, LV_ALIGN_OUT_BOTTOM_MID, 0, 0);
     lv_obj_set_style_text_color(lbl_kmh, lv_color_hex(0x666666), 0);
     lv_obj_set_style_text_font(lbl_kmh, &carbon_20, 0);
     lv_label_set_text(lbl_kmh, "km/h");
 
     // --- 2. Side Arcs ---
+    // Tracks are static, the live arcs only draw their indicator
     
     // Boost (Left)
+    create_arc_track(bg, 130, 230);
     arc_boost = lv_arc_create(scr);
     lv_obj_set_size(arc_boost, 700, 700); 
     lv_obj_align(arc_boost, LV_ALIGN_CENTER, 0, 0);
     lv_arc_set_bg_angles(arc_boost, 130, 230);
     lv_arc_set_rotation(arc_boost, 0);
     lv_obj_set_style_arc_width(arc_boost, 30, LV_PART_MAIN);
-    lv_obj_set_style_arc_color(arc_boost, lv_color_hex(0x111111), LV_PART_MAIN);
-    lv_obj_set_style_arc_rounded(arc_boost, false, LV_PART_MAIN); 
+    lv_obj_set_style_arc_opa(arc_boost, LV_OPA_TRANSP, LV_PART_MAIN);
     lv_obj_set_style_arc_width(arc_boost, 30, LV_PART_INDICATOR);
     lv_obj_set_style_arc_color(arc_boost, COLOR_TEAL, LV_PART_INDICATOR); 
     lv_obj_set_style_arc_rounded(arc_boost, false, LV_PART_INDICATOR); 
     lv_obj_remove_style(arc_boost, NULL, LV_PART_KNOB);
 
-    lv_obj_t * lbl_boost = lv_label_create(scr);
+    lv_obj_t * lbl_boost = lv_label_create(bg);
     lv_obj_align(lbl_boost, LV_ALIGN_CENTER, -270, 0); 
     lv_label_set_text(lbl_boost, "BST");
     lv_obj_set_style_text_font(lbl_boost, &carbon_20, 0);
@@ -118,20 +267,20 @@ void ui_init(void) {
 
 
     // Oil Pressure (Right)
+    create_arc_track(bg, 310, 50);
     arc_oilp = lv_arc_create(scr);
     lv_obj_set_size(arc_oilp, 700, 700);
     lv_obj_align(arc_oilp, LV_ALIGN_CENTER, 0, 0);
     lv_arc_set_bg_angles(arc_oilp, 310, 50); 
     lv_arc_set_rotation(arc_oilp, 0);
     lv_obj_set_style_arc_width(arc_oilp, 30, LV_PART_MAIN);
-    lv_obj_set_style_arc_color(arc_oilp, lv_color_hex(0x111111), LV_PART_MAIN);
-    lv_obj_set_style_arc_rounded(arc_oilp, false, LV_PART_MAIN);
+    lv_obj_set_style_arc_opa(arc_oilp, LV_OPA_TRANSP, LV_PART_MAIN);
     lv_obj_set_style_arc_width(arc_oilp, 30, LV_PART_INDICATOR);
     lv_obj_set_style_arc_color(arc_oilp, COLOR_TEAL, LV_PART_INDICATOR);
     lv_obj_set_style_arc_rounded(arc_oilp, false, LV_PART_INDICATOR);
     lv_obj_remove_style(arc_oilp, NULL, LV_PART_KNOB);
 
-    lv_obj_t * lbl_oil = lv_label_create(scr);
+    lv_obj_t * lbl_oil = lv_label_create(bg);
     lv_obj_align(lbl_oil, LV_ALIGN_CENTER, 250, 0); 
     lv_label_set_text(lbl_oil, "OIL");
     lv_obj_set_style_text_font(lbl_oil, &carbon_20, 0);
@@ -144,15 +293,17 @@ void ui_init(void) {
     lv_label_set_text(label_oilp_val, "0.0");
 
     // --- 3. Central Grid Stats ---
-    container_egt = create_stat_box(scr, "EGT", -92, -57, &label_egt_val);
-    container_oilt = create_stat_box(scr, "OIL T", 92, -57, &label_oilt_val);
-    container_iat = create_stat_box(scr, "IAT", -92, 57, &label_iat_val);
-    container_clt = create_stat_box(scr, "CLT", 92, 57, &label_clt_val);
+    container_egt = create_stat_box(bg, scr, "EGT", -92, -57, &label_egt_val);
+    container_oilt = create_stat_box(bg, scr, "OIL T", 92, -57, &label_oilt_val);
+    container_iat = create_stat_box(bg, scr, "IAT", -92, 57, &label_iat_val);
+    container_clt = create_stat_box(bg, scr, "CLT", 92, 57, &label_clt_val);
+
+    if (cache_static) bake_static_layer(scr, bg);
 }
 
 void ui_update_data(int rpm, int speed, float boost, float oil_press, int coolant_temp, int oil_temp, int egt, int iat) {
-    if (label_rpm_digit) lv_label_set_text_fmt(label_rpm_digit, "%d", rpm);
-    if (label_speed) lv_label_set_text_fmt(label_speed, "%d", speed);
+    set_label_int(label_rpm_digit, rpm);
+    set_label_int(label_speed, speed);
 
     if (arc_boost) {
         float boost_norm = (boost + 1.0f) / 3.0f; 
@@ -161,9 +312,9 @@ void ui_update_data(int rpm, int speed, float boost, float oil_press, int coolan
         int start = 130;
         int end = 130 + (int)(100 * boost_norm);
         lv_arc_set_angles(arc_boost, start, end);
-        if(label_boost_val) lv_label_set_text_fmt(label_boost_val, "%.1f", boost);
-        if (boost > 1.6f) lv_obj_set_style_arc_color(arc_boost, COLOR_BURGUNDY, LV_PART_INDICATOR);
-        else              lv_obj_set_style_arc_color(arc_boost, COLOR_TEAL, LV_PART_INDICATOR);
+        set_label_float(label_boost_val, boost);
+        shown_boost = boost;
+        set_arc_state(arc_boost, &boost_arc_state, boost_arc());
     }
 
     if (arc_oilp) {
@@ -174,19 +325,35 @@ void ui_update_data(int rpm, int speed, float boost, float oil_press, int coolan
         int start_dynamic = 50 - (int)(100 * oil_norm);
         if (start_dynamic < 0) start_dynamic += 360;
         lv_arc_set_angles(arc_oilp, start_dynamic, end_fixed);
-        if(label_oilp_val) lv_label_set_text_fmt(label_oilp_val, "%.1f", oil_press);
-        if (oil_press < 1.5f) lv_obj_set_style_arc_color(arc_oilp, COLOR_BURGUNDY, LV_PART_INDICATOR);
-        else                  lv_obj_set_style_arc_color(arc_oilp, COLOR_TEAL, LV_PART_INDICATOR);
+        set_label_float(label_oilp_val, oil_press);
+        shown_oil_press = oil_press;
+        set_arc_state(arc_oilp, &oilp_arc_state, oilp_arc());
     }
 
-    if (label_egt_val) lv_label_set_text_fmt(label_egt_val, "%d", egt);
-    if (label_iat_val) lv_label_set_text_fmt(label_iat_val, "%d", iat);
-    if (label_oilt_val) lv_label_set_text_fmt(label_oilt_val, "%d", oil_temp);
-    if (label_clt_val) lv_label_set_text_fmt(label_clt_val, "%d", coolant_temp);
+    set_label_int(label_egt_val, egt);
+    set_label_int(label_iat_val, iat);
+    set_label_int(label_oilt_val, oil_temp);
+    set_label_int(label_clt_val, coolant_temp);
+
+    // Only on change: setting a style invalidates the whole box
+    set_box_alarm(container_clt, &clt_alarm, coolant_temp > 105);
+    set_box_alarm(container_oilt, &oilt_alarm, oil_temp > 130);
+}
 
-    if (coolant_temp > 105) lv_obj_set_style_bg_color(container_clt, COLOR_BURGUNDY, 0);
-    else lv_obj_set_style_bg_color(container_clt, COLOR_BOX_BG, 0);
+void ui_set_stale(ui_readout_t readout, bool is_stale) {
+    if ((unsigned)readout >= UI_READOUT_COUNT || stale[readout] == is_stale) return;
+    stale[readout] = is_stale;
 
-    if (oil_temp > 130) lv_obj_set_style_bg_color(container_oilt, COLOR_BURGUNDY, 0);
-    else lv_obj_set_style_bg_color(container_oilt, COLOR_BOX_BG, 0);
-}
\ No newline at end of file
+    lv_obj_t * labels[UI_READOUT_COUNT] = {
+        [UI_RPM] = label_rpm_digit,     [UI_SPEED] = label_speed,
+        [UI_BOOST] = label_boost_val,   [UI_OIL_PRESS] = label_oilp_val,
+        [UI_CLT] = label_clt_val,       [UI_OIL_TEMP] = label_oilt_val,
+        [UI_EGT] = label_egt_val,       [UI_IAT] = label_iat_val,
+    };
+    if (labels[readout]) {
+        lv_obj_set_style_text_color(labels[readout], is_stale ? COLOR_STALE : COLOR_TEXT, 0);
+    }
+    // Here too: with the bus silent, ui_update_data is not called at all
+    if (readout == UI_BOOST) set_arc_state(arc_boost, &boost_arc_state, boost_arc());
+    else if (readout == UI_OIL_PRESS) set_arc_state(arc_oilp, &oilp_arc_state, oilp_arc());
+}
@@ -3,11 +3,34 @@
 
 #include "lvgl.h"
 
-void ui_init(void);
+// Readouts that can be greyed out when their data stops arriving
+typedef enum {
+    UI_RPM = 0,
+    UI_SPEED,
+    UI_BOOST,
+    UI_OIL_PRESS,
+    UI_CLT,
+    UI_OIL_TEMP,
+    UI_EGT,
+    UI_IAT,
+    UI_READOUT_COUNT
+} ui_readout_t;
+
+// cache_static: render the widgets that never change once into an image
+// under the live ones (false draws them live, for comparison)
+void ui_init(bool cache_static);
 
 // Updated with new sensor arguments
 void ui_update_data(int rpm, int speed, 
                     float boost, float oil_press, 
                     int coolant_temp, int oil_temp, int egt, int iat);
 
+// Grey out a readout whose value is no longer being updated
+void ui_set_stale(ui_readout_t readout, bool stale);
+
+// Count the draw tasks (draw calls) LVGL creates for the current screen,
+// benchmark only: call after ui_init, read and reset once per frame
+void ui_count_draw_tasks(void);
+uint32_t ui_take_draw_tasks(void);
+
 #endif
@@ -0,0 +1,57 @@
+#include "frame_prof.h"
+
+#ifdef MR2_FRAME_PROFILER
+#include "histogram.h"
+#include <stdio.h>
+#include <signal.h>
+
+static const char* const phase_names[FRAME_PROF_COUNT] = {
+    [FRAME_PROF_CAN_READ]  = "can read",
+    [FRAME_PROF_UI_UPDATE] = "ui update",
+    [FRAME_PROF_TIMERS]    = "lv_timer_handler",
+    [FRAME_PROF_RENDER]    = "render (lv_refr_now)",
+    [FRAME_PROF_FLUSH]     = "flush per frame",
+    [FRAME_PROF_PRESENT]   = "present",
+    [FRAME_PROF_PASS]      = "loop pass with frame",
+};
+
+static histogram_t phases[FRAME_PROF_COUNT];
+static volatile sig_atomic_t report_requested = 0;
+
+#ifdef SIGUSR1
+static void on_sigusr1(int sig) {
+    (void)sig;
+    report_requested = 1;
+}
+#endif
+
+void frame_prof_init(void) {
+    for (int i = 0; i < FRAME_PROF_COUNT; i++) histogram_reset(&phases[i]);
+#ifdef SIGUSR1
+    struct sigaction sa = { 0 };
+    sa.sa_handler = on_sigusr1;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &sa, NULL);
+#endif
+}
+
+void frame_prof_add(frame_prof_phase_t phase, uint64_t ns) {
+    histogram_add(&phases[phase], ns);
+}
+
+void frame_prof_poll(void) {
+    if (!report_requested) return;
+    report_requested = 0;
+    frame_prof_print();
+    fflush(stdout);
+}
+
+void frame_prof_print(void) {
+    printf("PROF: frame phases (us):\n");
+    for (int i = 0; i < FRAME_PROF_COUNT; i++) {
+        if (phases[i].count) histogram_print(&phases[i], "PROF:   ", phase_names[i], 1000.0, "us");
+    }
+}
+
+#endif // MR2_FRAME_PROFILER
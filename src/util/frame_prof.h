@@ -0,0 +1,48 @@
+#ifndef FRAME_PROF_H
+#define FRAME_PROF_H
+
+#include <stdint.h>
+
+// Per-phase timing of the render loop. Each phase feeds a fixed histogram
+// (no allocation, two clock reads per phase). The report goes to stdout at
+// exit and whenever the process gets SIGUSR1:
+//   kill -USR1 $(pidof MR2_Dash)
+// Configure with -DMR2_FRAME_PROFILER=OFF to compile all of it out.
+
+typedef enum {
+    FRAME_PROF_CAN_READ = 0,    // can_get_snapshot + channel status
+    FRAME_PROF_UI_UPDATE,       // ui_update_data (widget setters)
+    FRAME_PROF_TIMERS,          // lv_timer_handler, incl. any render it starts
+    FRAME_PROF_RENDER,          // lv_refr_now, incl. flush
+    FRAME_PROF_FLUSH,           // Flush callbacks of one frame (upload / unlock)
+    FRAME_PROF_PRESENT,         // SDL_RenderPresent / DRM page flip queueing
+    FRAME_PROF_PASS,            // Whole loop pass that produced a frame
+    FRAME_PROF_COUNT
+} frame_prof_phase_t;
+
+#ifdef MR2_FRAME_PROFILER
+#include "mono_time.h"
+
+// Installs the SIGUSR1 handler
+void frame_prof_init(void);
+void frame_prof_add(frame_prof_phase_t phase, uint64_t ns);
+// Prints the report if SIGUSR1 arrived since the last call (render loop only)
+void frame_prof_poll(void);
+void frame_prof_print(void);
+
+#define FRAME_PROF_START(t)        uint64_t t = mono_time_ns()
+#define FRAME_PROF_STOP(phase, t)  frame_prof_add((phase), mono_time_ns() - (t))
+
+#else
+
+static inline void frame_prof_init(void) {}
+static inline void frame_prof_add(frame_prof_phase_t phase, uint64_t ns) { (void)phase; (void)ns; }
+static inline void frame_prof_poll(void) {}
+static inline void frame_prof_print(void) {}
+
+#define FRAME_PROF_START(t)
+#define FRAME_PROF_STOP(phase, t)
+
+#endif
+
+#endif // FRAME_PROF_H
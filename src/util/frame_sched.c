@@ -0,0 +1,79 @@
+#include "frame_sched.h"
+#include "mono_time.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <time.h>
+
+static void sleep_until_ns(uint64_t t) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(t / 1000000000ull);
+    ts.tv_nsec = (long)(t % 1000000000ull);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {}
+}
+
+#else // --- WINDOWS SIMULATION ---
+#include <SDL.h>
+
+static void sleep_until_ns(uint64_t t) {
+    uint64_t now = mono_time_ns();
+    if (t > now) SDL_Delay((uint32_t)((t - now) / 1000000ull));
+}
+#endif
+
+void frame_sched_init(frame_sched_t* s, int hz) {
+    memset(s, 0, sizeof(*s));
+    if (hz < 1) hz = 1;
+    s->period_ns = 1000000000ull / (uint64_t)hz;
+    s->next_ns = mono_time_ns() + s->period_ns;
+    histogram_reset(&s->lateness);
+    histogram_reset(&s->jitter);
+}
+
+// Records the frame starting at now, returns the interval since the last one (0 for the first)
+static uint64_t count_frame(frame_sched_t* s, uint64_t now) {
+    uint64_t interval = s->last_tick_ns ? now - s->last_tick_ns : 0;
+    if (interval) {
+        uint64_t dev = interval > s->period_ns ? interval - s->period_ns : s->period_ns - interval;
+        histogram_add(&s->jitter, dev / 1000);
+    }
+    s->last_tick_ns = now;
+    s->frames++;
+    return interval;
+}
+
+void frame_sched_tick(frame_sched_t* s) {
+    uint64_t interval = count_frame(s, mono_time_ns());
+    // Half a period over means a refresh went by without a frame
+    if (interval > s->period_ns + s->period_ns / 2) {
+        s->missed += (interval - s->period_ns / 2) / s->period_ns;
+        s->late_frames++;
+    }
+}
+
+void frame_sched_wait(frame_sched_t* s) {
+    sleep_until_ns(s->next_ns);
+
+    uint64_t now = mono_time_ns();
+    uint64_t late = now > s->next_ns ? now - s->next_ns : 0;
+    histogram_add(&s->lateness, late / 1000);
+    count_frame(s, now);
+
+    // Previous frame overran: skip the deadlines already gone
+    uint64_t skip = late / s->period_ns;
+    if (skip) {
+        s->missed += skip;
+        s->late_frames++;
+    }
+    s->next_ns += (skip + 1) * s->period_ns;
+}
+
+void frame_sched_print(const frame_sched_t* s, const char* prefix) {
+    printf("%sframe pacing at %.2f Hz: %llu frames, %llu deadlines missed, %llu frames late\n",
+           prefix, 1e9 / (double)s->period_ns, (unsigned long long)s->frames,
+           (unsigned long long)s->missed, (unsigned long long)s->late_frames);
+    if (s->lateness.count) histogram_print(&s->lateness, prefix, "frame start after deadline", 1000.0, "ms");
+    histogram_print(&s->jitter, prefix, "frame interval jitter", 1000.0, "ms");
+}
@@ -0,0 +1,36 @@
+#ifndef FRAME_SCHED_H
+#define FRAME_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "histogram.h"
+
+// Fixed-rate frame pacing. Deadlines are absolute multiples of the period on
+// the monotonic clock, so a late frame does not shift the ones after it.
+// A frame that starts a whole period or more late counts as missed and the
+// schedule skips ahead instead of bursting to catch up.
+
+typedef struct {
+    uint64_t period_ns;
+    uint64_t next_ns;           // Next deadline (mono_time_ns)
+    uint64_t last_tick_ns;      // Start of the previous frame
+    uint64_t frames;
+    uint64_t missed;            // Deadlines that passed without a frame
+    uint64_t late_frames;       // Frames that started one period or more late
+    histogram_t lateness;       // Frame start - deadline (us)
+    histogram_t jitter;         // |frame interval - period| (us)
+} frame_sched_t;
+
+void frame_sched_init(frame_sched_t* s, int hz);
+
+// Sleep until the next deadline (clock_nanosleep, TIMER_ABSTIME) and account
+// the frame that starts now
+void frame_sched_wait(frame_sched_t* s);
+
+// Account a frame whose timing was set by something else (vsync present).
+// Only the interval is known, so lateness is not recorded.
+void frame_sched_tick(frame_sched_t* s);
+
+void frame_sched_print(const frame_sched_t* s, const char* prefix);
+
+#endif // FRAME_SCHED_H
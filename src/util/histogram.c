@@ -0,0 +1,66 @@
+#include "histogram.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SUB_COUNT (1u << HISTOGRAM_SUB_BITS)
+
+static unsigned int bucket_of(uint64_t v) {
+    if (v < SUB_COUNT) return (unsigned int)v;
+    unsigned int msb = 63u - (unsigned int)__builtin_clzll(v);
+    unsigned int sub = (unsigned int)(v >> (msb - HISTOGRAM_SUB_BITS)) & (SUB_COUNT - 1);
+    return ((msb - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS) + sub;
+}
+
+// Largest value that still lands in bucket b
+static uint64_t bucket_top(unsigned int b) {
+    if (b < SUB_COUNT) return b;
+    unsigned int msb = (b >> HISTOGRAM_SUB_BITS) + HISTOGRAM_SUB_BITS - 1;
+    uint64_t sub = b & (SUB_COUNT - 1);
+    uint64_t step = 1ull << (msb - HISTOGRAM_SUB_BITS);
+    return ((SUB_COUNT + sub) << (msb - HISTOGRAM_SUB_BITS)) + (step - 1);
+}
+
+void histogram_reset(histogram_t* h) {
+    memset(h, 0, sizeof(*h));
+    h->min = UINT64_MAX;
+}
+
+void histogram_add(histogram_t* h, uint64_t value) {
+    h->buckets[bucket_of(value)]++;
+    h->count++;
+    h->sum += value;
+    if (value < h->min) h->min = value;
+    if (value > h->max) h->max = value;
+}
+
+uint64_t histogram_percentile(const histogram_t* h, double p) {
+    if (h->count == 0) return 0;
+    uint64_t rank = (uint64_t)((double)h->count * p / 100.0 + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > h->count) rank = h->count;
+
+    uint64_t seen = 0;
+    for (unsigned int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+        seen += h->buckets[b];
+        if (seen >= rank) {
+            uint64_t top = bucket_top(b);
+            return top < h->max ? top : h->max;
+        }
+    }
+    return h->max;
+}
+
+void histogram_print(const histogram_t* h, const char* prefix, const char* name,
+                     double div, const char* unit) {
+    if (h->count == 0) {
+        printf("%s%s: no samples\n", prefix, name);
+        return;
+    }
+    printf("%s%s: n %llu, min %.2f avg %.2f p50 %.2f p99 %.2f max %.2f %s\n",
+           prefix, name, (unsigned long long)h->count,
+           (double)h->min / div,
+           (double)h->sum / (double)h->count / div,
+           (double)histogram_percentile(h, 50.0) / div,
+           (double)histogram_percentile(h, 99.0) / div,
+           (double)h->max / div, unit);
+}
@@ -0,0 +1,32 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+
+// Fixed-size histogram for latency / timing samples. Buckets are log2 octaves
+// split into 8 linear steps (12.5% resolution), so adding a sample is O(1),
+// never allocates and is fine to call once per frame.
+
+#define HISTOGRAM_SUB_BITS 3
+#define HISTOGRAM_BUCKETS  ((64 - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS)
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+    uint32_t buckets[HISTOGRAM_BUCKETS];
+} histogram_t;
+
+void histogram_reset(histogram_t* h);
+void histogram_add(histogram_t* h, uint64_t value);
+
+// Upper bound of the bucket holding the p-th percentile (0..100), capped at max
+uint64_t histogram_percentile(const histogram_t* h, double p);
+
+// One line: "<prefix><name>: n N, min/avg/p50/p99/max ... <unit>", values
+// divided by div (e.g. 1000 to print microsecond samples as ms)
+void histogram_print(const histogram_t* h, const char* prefix, const char* name,
+                     double div, const char* unit);
+
+#endif // HISTOGRAM_H
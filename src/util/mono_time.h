@@ -0,0 +1,32 @@
+#ifndef MONO_TIME_H
+#define MONO_TIME_H
+
+#include <stdint.h>
+
+// Monotonic clock shared by all threads, so timestamps taken in the CAN
+// thread can be compared against the render loop.
+#ifdef __linux__
+#include <time.h>
+
+static inline uint64_t mono_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+#else
+#include <SDL.h>
+
+static inline uint64_t mono_time_ns(void) {
+    static uint64_t freq = 0;
+    if (!freq) freq = SDL_GetPerformanceFrequency();
+    uint64_t c = SDL_GetPerformanceCounter();
+    return (c / freq) * 1000000000ull + ((c % freq) * 1000000000ull) / freq;
+}
+#endif
+
+static inline uint64_t mono_time_us(void) {
+    return mono_time_ns() / 1000ull;
+}
+
+#endif // MONO_TIME_H
@@ -0,0 +1,67 @@
+#include "rgb565.h"
+#include <stddef.h>
+
+// Bayer matrix scaled to the bits each channel loses: 3 for red and blue
+// (0..7), 2 for green (0..3)
+static const uint8_t bayer_rb[4][4] = {
+    { 0, 4, 1, 5 },
+    { 6, 2, 7, 3 },
+    { 1, 5, 0, 4 },
+    { 7, 3, 6, 2 },
+};
+static const uint8_t bayer_g[4][4] = {
+    { 0, 2, 0, 2 },
+    { 3, 1, 3, 1 },
+    { 0, 2, 0, 2 },
+    { 3, 1, 3, 1 },
+};
+
+// Channel value -> its bits of the 565 pixel, per matrix cell (row * 4 + column)
+static uint16_t lut_r[16][256], lut_g[16][256], lut_b[16][256];
+static bool lut_ready = false;
+
+static void build_lut(void) {
+    for (int cell = 0; cell < 16; cell++) {
+        uint32_t add_rb = bayer_rb[cell >> 2][cell & 3];
+        uint32_t add_g = bayer_g[cell >> 2][cell & 3];
+        for (uint32_t v = 0; v < 256; v++) {
+            uint32_t rb = v + add_rb > 0xFF ? 0xFF : v + add_rb;
+            uint32_t g = v + add_g > 0xFF ? 0xFF : v + add_g;
+            lut_r[cell][v] = (uint16_t)((rb >> 3) << 11);
+            lut_g[cell][v] = (uint16_t)((g >> 2) << 5);
+            lut_b[cell][v] = (uint16_t)(rb >> 3);
+        }
+    }
+    lut_ready = true;
+}
+
+static inline uint16_t pack(uint32_t c, int cell) {
+    return lut_r[cell][(c >> 16) & 0xFF] | lut_g[cell][(c >> 8) & 0xFF] | lut_b[cell][c & 0xFF];
+}
+
+void rgb565_convert(const uint8_t* src, int32_t src_stride, uint16_t* dst, int32_t dst_stride,
+                    int32_t w, int32_t h, int32_t x, int32_t y, bool dither) {
+    if (!lut_ready) build_lut();
+    for (int32_t row = 0; row < h; row++) {
+        const uint32_t* s = (const uint32_t*)(src + (size_t)row * src_stride);
+        uint16_t* d = (uint16_t*)((uint8_t*)dst + (size_t)row * dst_stride);
+        if (!dither) {
+            for (int32_t i = 0; i < w; i++) {
+                uint32_t c = s[i];
+                d[i] = (uint16_t)(((c >> 8) & 0xF800) | ((c >> 5) & 0x07E0) | ((c >> 3) & 0x001F));
+            }
+            continue;
+        }
+        int cell0 = ((y + row) & 3) << 2;
+        int32_t i = 0;
+        for (; i < w && ((x + i) & 3); i++) d[i] = pack(s[i], cell0 | ((x + i) & 3));
+        // Four pixels per step, one per column of the matrix
+        for (; i + 4 <= w; i += 4) {
+            d[i] = pack(s[i], cell0);
+            d[i + 1] = pack(s[i + 1], cell0 | 1);
+            d[i + 2] = pack(s[i + 2], cell0 | 2);
+            d[i + 3] = pack(s[i + 3], cell0 | 3);
+        }
+        for (; i < w; i++) d[i] = pack(s[i], cell0 | ((x + i) & 3));
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef RGB565_H
+#define RGB565_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ARGB8888 -> RGB565 conversion for the --color 565-dither flush: LVGL
+// renders in 32 bit and only the upload is 16 bit. The ordered (4x4 Bayer)
+// dither is keyed to screen coordinates, so a redrawn area matches the
+// pixels around it and static content does not shimmer between frames.
+
+// Convert a w x h block whose first pixel is at screen position (x, y).
+// Strides are in bytes.
+void rgb565_convert(const uint8_t* src, int32_t src_stride, uint16_t* dst, int32_t dst_stride,
+                    int32_t w, int32_t h, int32_t x, int32_t y, bool dither);
+
+#endif // RGB565_H
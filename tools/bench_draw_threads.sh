@@ -0,0 +1,38 @@
+#!/bin/bash
+# Render scaling with the number of LVGL software draw threads: builds the
+# dashboard once per thread count (MR2_DRAW_THREADS) and runs the synthetic
+# RPM sweep (--bench-render) headless with each build.
+#
+# Usage: tools/bench_draw_threads.sh [build_prefix]
+# Environment: THREADS ("1 2 3 4"), FRAMES (600),
+#              DASH_ARGS (extra dashboard options, e.g. "--render-mode full")
+# Builds go to <build_prefix>-dt<N> (default build-dt1 ...).
+# Report: draw-threads-report.txt
+
+PREFIX="${1:-build}"
+THREADS="${THREADS:-1 2 3 4}"
+FRAMES="${FRAMES:-600}"
+DASH_ARGS="${DASH_ARGS:-}"
+REPORT="draw-threads-report.txt"
+
+echo "MR2 Dash draw thread scaling, $(date), $FRAMES frames ${DASH_ARGS}" > "$REPORT"
+printf "%-8s %10s %10s %10s %10s\n" "threads" "avg ms" "p50 ms" "p99 ms" "speedup" | tee -a "$REPORT"
+
+base=""
+for n in $THREADS; do
+    dir="$PREFIX-dt$n"
+    cmake -S . -B "$dir" -DMR2_DRAW_THREADS="$n" > /dev/null || exit 2
+    cmake --build "$dir" -j"$(nproc)" --target MR2_Dash > /dev/null || exit 2
+
+    log="$dir/bench-render.log"
+    SDL_VIDEODRIVER=dummy "$dir/MR2_Dash" --no-rec --bench-render "$FRAMES" $DASH_ARGS > "$log" 2>&1
+    # BENCH: frame time: n N, min a avg b p50 c p99 d max e ms
+    read -r avg p50 p99 < <(awk '/BENCH: frame time:/ { print $9, $11, $13 }' "$log")
+    if [ -z "$avg" ]; then
+        echo "No frame time from $dir, see $log" | tee -a "$REPORT"
+        continue
+    fi
+    [ -z "$base" ] && base="$avg"
+    speedup=$(awk -v b="$base" -v a="$avg" 'BEGIN { printf "%.2fx", a > 0 ? b / a : 0 }')
+    printf "%-8s %10s %10s %10s %10s\n" "$n" "$avg" "$p50" "$p99" "$speedup" | tee -a "$REPORT"
+done
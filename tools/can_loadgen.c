@@ -0,0 +1,203 @@
+// CAN traffic generator for load tests on a (virtual) SocketCAN interface.
+// Sends the EMU Black stream (base..base+7) at a fixed rate per frame and
+// fills the rest of the requested bus load with random foreign IDs, so the
+// dashboard's filter, receive and decode paths see a saturated bus.
+//
+// Usage: can_loadgen [--if vcan0] [--bitrate 500000] [--load 100]
+//                    [--emu-hz 50] [--emu-base 0x600] [--eff PCT]
+//                    [--seconds 10] [--seed N]
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+#define TICK_US   1000
+#define EMU_COUNT 8
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+// Nominal bits on the wire: SOF..EOF plus 3 bit interframe space, no bit
+// stuffing. Real frames are a little longer, so "100%" slightly overdrives
+// the bus, which is the point of a stress test.
+static unsigned frame_bits(const struct can_frame* f) {
+    unsigned overhead = (f->can_id & CAN_EFF_FLAG) ? 67 : 47;
+    return overhead + 8u * f->can_dlc;
+}
+
+// xorshift, so runs are repeatable for a given seed
+static uint32_t rng_state = 1;
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// EMU frame with a believable RPM sweep in frame 0; the other frames carry
+// noise, the decoder clamps it
+static void make_emu_frame(struct can_frame* f, uint32_t base, int idx, uint64_t t_us) {
+    memset(f, 0, sizeof(*f));
+    f->can_id = base + (uint32_t)idx;
+    f->can_dlc = 8;
+    for (int b = 0; b < 8; b++) f->data[b] = (uint8_t)rng();
+    if (idx == 0) {
+        uint32_t phase = (uint32_t)((t_us / 1000) % 4000);   // 4 s triangle
+        uint32_t rpm = 800 + (phase < 2000 ? phase : 4000 - phase) * 36 / 10;
+        f->data[0] = (uint8_t)rpm;
+        f->data[1] = (uint8_t)(rpm >> 8);
+    }
+}
+
+static void make_foreign_frame(struct can_frame* f, uint32_t base, int eff_pct) {
+    memset(f, 0, sizeof(*f));
+    if ((int)(rng() % 100) < eff_pct) {
+        f->can_id = (rng() & CAN_EFF_MASK) | CAN_EFF_FLAG;
+    } else {
+        do {
+            f->can_id = rng() & CAN_SFF_MASK;
+        } while (f->can_id >= base && f->can_id < base + EMU_COUNT);
+    }
+    f->can_dlc = (uint8_t)(rng() % 9);
+    for (int b = 0; b < f->can_dlc; b++) f->data[b] = (uint8_t)rng();
+}
+
+int main(int argc, char** argv) {
+    const char* ifname = "vcan0";
+    long bitrate = 500000;
+    double load = 100.0;
+    double emu_hz = 50.0;
+    uint32_t base = 0x600;
+    int eff_pct = 0;
+    int seconds = 10;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--if") == 0 && i + 1 < argc) {
+            ifname = argv[++i];
+        } else if (strcmp(argv[i], "--bitrate") == 0 && i + 1 < argc) {
+            bitrate = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+            load = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--emu-hz") == 0 && i + 1 < argc) {
+            emu_hz = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--emu-base") == 0 && i + 1 < argc) {
+            base = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--eff") == 0 && i + 1 < argc) {
+            eff_pct = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            rng_state = (uint32_t)strtoul(argv[++i], NULL, 0);
+            if (!rng_state) rng_state = 1;
+        } else {
+            printf("Usage: %s [--if IF] [--bitrate BPS] [--load PCT] [--emu-hz HZ] [--emu-base ID] [--eff PCT] [--seconds S] [--seed N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int s = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (s < 0) {
+        perror("LOADGEN: socket");
+        return 1;
+    }
+    setsockopt(s, SOL_CAN_RAW, CAN_RAW_FILTER, NULL, 0);   // Send only
+
+    struct sockaddr_can addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = (int)if_nametoindex(ifname);
+    if (addr.can_ifindex == 0 || bind(s, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("LOADGEN: bind");
+        return 1;
+    }
+
+    printf("LOADGEN: %s, %ld bit/s at %.0f%% load, EMU 0x%X..0x%X at %.0f Hz each, %d s\n",
+           ifname, bitrate, load, base, base + EMU_COUNT - 1, emu_hz, seconds);
+
+    uint64_t emu_period_us = emu_hz > 0.0 ? (uint64_t)(1e6 / emu_hz) : 0;
+    double bits_per_tick = (double)bitrate * load / 100.0 * TICK_US / 1e6;
+
+    uint64_t emu_sent[EMU_COUNT] = { 0 };
+    uint64_t foreign_sent = 0, bits_sent = 0, tx_full = 0, late_ticks = 0;
+    uint64_t emu_due[EMU_COUNT];
+
+    uint64_t start = now_us();
+    uint64_t end = start + (uint64_t)seconds * 1000000u;
+    for (int i = 0; i < EMU_COUNT; i++) emu_due[i] = start + emu_period_us * (uint64_t)i / EMU_COUNT;
+
+    double credit = 0.0;            // Bits we may still send
+    struct can_frame f;
+    struct can_frame pending;
+    bool have_foreign = false;      // pending could not be sent last tick
+    struct timespec next = { (time_t)(start / 1000000u), (long)(start % 1000000u) * 1000 };
+
+    for (uint64_t tick_t = start; tick_t < end; tick_t += TICK_US) {
+        credit += bits_per_tick;
+        if (credit > bits_per_tick * 10) credit = bits_per_tick * 10;   // No huge bursts after a stall
+
+        // EMU frames first: they are what the dashboard must not lose
+        for (int i = 0; emu_period_us && i < EMU_COUNT; i++) {
+            while (emu_due[i] <= tick_t) {
+                make_emu_frame(&f, base, i, tick_t);
+                if (send(s, &f, sizeof(f), MSG_DONTWAIT) == (ssize_t)sizeof(f)) {
+                    emu_sent[i]++;
+                    bits_sent += frame_bits(&f);
+                    credit -= frame_bits(&f);
+                } else {
+                    tx_full++;
+                }
+                emu_due[i] += emu_period_us;
+            }
+        }
+
+        // Fill the remaining budget with foreign traffic
+        while (credit > 0.0) {
+            if (!have_foreign) make_foreign_frame(&pending, base, eff_pct);
+            if (send(s, &pending, sizeof(pending), MSG_DONTWAIT) != (ssize_t)sizeof(pending)) {
+                if (errno == ENOBUFS || errno == EAGAIN) tx_full++;
+                else perror("LOADGEN: send");
+                have_foreign = true;
+                break;
+            }
+            have_foreign = false;
+            foreign_sent++;
+            bits_sent += frame_bits(&pending);
+            credit -= frame_bits(&pending);
+        }
+
+        next.tv_nsec += TICK_US * 1000;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        if (now_us() > tick_t + 2 * TICK_US) late_ticks++;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+
+    double secs = (double)(now_us() - start) / 1e6;
+    uint64_t emu_total = 0;
+    for (int i = 0; i < EMU_COUNT; i++) emu_total += emu_sent[i];
+
+    printf("LOADGEN: emu frames sent %llu\n", (unsigned long long)emu_total);
+    for (int i = 0; i < EMU_COUNT; i++)
+        printf("LOADGEN:   ID 0x%03X: %llu\n", base + (uint32_t)i, (unsigned long long)emu_sent[i]);
+    printf("LOADGEN: foreign frames sent %llu\n", (unsigned long long)foreign_sent);
+    printf("LOADGEN: %.0f frames/s, achieved load %.1f%% of %ld bit/s\n",
+           (double)(emu_total + foreign_sent) / secs, 100.0 * (double)bits_sent / secs / (double)bitrate, bitrate);
+    printf("LOADGEN: tx queue full %llu times, %llu late ticks\n",
+           (unsigned long long)tx_full, (unsigned long long)late_ticks);
+    close(s);
+    return 0;
+}
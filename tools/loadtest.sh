@@ -0,0 +1,93 @@
+#!/bin/bash
+# Headless load test: run the dashboard against vcan0 while can_loadgen
+# saturates the bus, then check dropped EMU frames and UI frame times.
+#
+# Usage: tools/loadtest.sh [build_dir]
+# Environment: LOAD_SECONDS (10), LOAD_PCT (100), BITRATES ("500000 1000000"),
+#              CAN_IF (vcan0), MAX_DROPPED (0), MAX_FRAME_P99_MS (16.7),
+#              DASH_ARGS (extra dashboard options, e.g. "--display drm")
+# Exits non-zero if any run breaks a limit. Report: loadtest-report.txt
+
+BUILD_DIR="${1:-build}"
+APP="$BUILD_DIR/MR2_Dash"
+GEN="$BUILD_DIR/can_loadgen"
+LOAD_SECONDS="${LOAD_SECONDS:-10}"
+LOAD_PCT="${LOAD_PCT:-100}"
+BITRATES="${BITRATES:-500000 1000000}"
+CAN_IF="${CAN_IF:-vcan0}"
+MAX_DROPPED="${MAX_DROPPED:-0}"
+MAX_FRAME_P99_MS="${MAX_FRAME_P99_MS:-16.7}"
+DASH_ARGS="${DASH_ARGS:-}"
+REPORT="loadtest-report.txt"
+WORK_DIR="$(mktemp -d)"
+
+if [ ! -x "$APP" ] || [ ! -x "$GEN" ]; then
+    echo "Build first: $APP and $GEN are needed."
+    exit 2
+fi
+
+# 1. Virtual CAN interface
+if ! ip link show "$CAN_IF" > /dev/null 2>&1; then
+    echo "Creating $CAN_IF (needs sudo)..."
+    sudo modprobe vcan || exit 2
+    sudo ip link add dev "$CAN_IF" type vcan || exit 2
+fi
+sudo ip link set "$CAN_IF" up || exit 2
+
+# 2. One dashboard + generator run per bitrate
+echo "MR2 Dash load test, $(date) ${DASH_ARGS}" > "$REPORT"
+failed=0
+
+for bitrate in $BITRATES; do
+    dash_log="$WORK_DIR/dash-$bitrate.log"
+    gen_log="$WORK_DIR/gen-$bitrate.log"
+
+    # No display needed: SDL dummy video driver, software rendering
+    SDL_VIDEODRIVER=dummy "$APP" --can-if "$CAN_IF" --no-rec \
+        --run-seconds $((LOAD_SECONDS + 3)) $DASH_ARGS > "$dash_log" 2>&1 &
+    dash_pid=$!
+    sleep 1
+
+    "$GEN" --if "$CAN_IF" --bitrate "$bitrate" --load "$LOAD_PCT" \
+        --seconds "$LOAD_SECONDS" > "$gen_log" 2>&1
+    wait "$dash_pid"
+
+    # 3. Extract the numbers
+    sent=$(awk '/LOADGEN: emu frames sent/ { print $5 }' "$gen_log")
+    load=$(awk '/achieved load/ { print $6 }' "$gen_log")
+    received=$(awk '/CAN:   ID 0x60[0-7]:/ { sum += $4 } END { print sum + 0 }' "$dash_log")
+    overflow=$(awk -F'queue overflows ' '/queue overflows/ { print $2 + 0 }' "$dash_log")
+    cpu=$(awk '/receive thread CPU/ { print $(NF-3) }' "$dash_log" | tr -d '(')
+    frame_line=$(grep "UI: frame time:" "$dash_log")
+    p50=$(echo "$frame_line" | awk '{ for (i = 1; i < NF; i++) if ($i == "p50") print $(i+1) }')
+    p99=$(echo "$frame_line" | awk '{ for (i = 1; i < NF; i++) if ($i == "p99") print $(i+1) }')
+    fmax=$(echo "$frame_line" | awk '{ for (i = 1; i < NF; i++) if ($i == "max") print $(i+1) }')
+    dropped=$(( ${sent:-0} - ${received:-0} ))
+
+    verdict="PASS"
+    if [ -z "$sent" ] || [ -z "$p99" ]; then
+        verdict="FAIL (missing output, see logs)"
+    elif [ "$dropped" -gt "$MAX_DROPPED" ]; then
+        verdict="FAIL (dropped EMU frames)"
+    elif awk -v a="$p99" -v b="$MAX_FRAME_P99_MS" 'BEGIN { exit !(a > b) }'; then
+        verdict="FAIL (frame time p99)"
+    fi
+    [ "$verdict" = "PASS" ] || failed=1
+
+    {
+        echo
+        echo "== $bitrate bit/s, $LOAD_PCT% load requested ($load achieved), $LOAD_SECONDS s =="
+        echo "EMU frames sent $sent, received $received, dropped $dropped, socket queue overflows ${overflow:-n/a}"
+        echo "CAN receive thread CPU ${cpu:-n/a} of one core"
+        echo "UI frame time p50 ${p50:-n/a} ms, p99 ${p99:-n/a} ms, max ${fmax:-n/a} ms"
+        echo "$verdict"
+        echo "-- dashboard --"
+        grep -E "^(CAN|UI|DRM):" "$dash_log" | grep -v "CAN:   ID"
+        echo "-- generator --"
+        cat "$gen_log"
+    } >> "$REPORT"
+done
+
+cat "$REPORT"
+rm -rf "$WORK_DIR"
+exit $failed